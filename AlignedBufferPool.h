@@ -0,0 +1,112 @@
+#ifndef ALIGNED_BUFFER_POOL_H
+#define ALIGNED_BUFFER_POOL_H
+
+#include <cstdlib>
+#include <cstddef>
+#include <mutex>
+#include <new>
+#include <vector>
+
+// 对齐缓冲区池：O_DIRECT要求缓冲区地址、长度和文件偏移都按块对齐
+// 不超过bufferBytes的请求复用池中的缓冲区，更大的请求临时分配，释放时直接归还系统
+class AlignedBufferPool {
+public:
+    // 从池中取得的缓冲区，析构时归还；必须在池之前释放
+    class Buffer {
+    public:
+        Buffer() : pool(nullptr), ptr(nullptr), len(0) {}
+        Buffer(Buffer&& other) : pool(other.pool), ptr(other.ptr), len(other.len) {
+            other.ptr = nullptr;
+        }
+        Buffer& operator=(Buffer&& other) {
+            if (this != &other) {
+                reset();
+                pool = other.pool;
+                ptr = other.ptr;
+                len = other.len;
+                other.ptr = nullptr;
+            }
+            return *this;
+        }
+        Buffer(const Buffer&) = delete;
+        Buffer& operator=(const Buffer&) = delete;
+        ~Buffer() { reset(); }
+
+        char* data() const { return ptr; }
+        size_t size() const { return len; }
+
+    private:
+        friend class AlignedBufferPool;
+        Buffer(AlignedBufferPool* pool, char* ptr, size_t len) : pool(pool), ptr(ptr), len(len) {}
+
+        void reset() {
+            if (ptr) pool->release(ptr, len);
+            ptr = nullptr;
+        }
+
+        AlignedBufferPool* pool;
+        char* ptr;
+        size_t len;
+    };
+
+    // alignment为块大小(2的幂)，bufferBytes为池中缓冲区的大小，maxPooled为最多保留的空闲缓冲区数
+    AlignedBufferPool(size_t alignment, size_t bufferBytes, size_t maxPooled)
+        : align(alignment), bufferBytes(roundUp(bufferBytes)), maxPooled(maxPooled) {}
+
+    ~AlignedBufferPool() {
+        for (char* p : idle) std::free(p);
+    }
+
+    AlignedBufferPool(const AlignedBufferPool&) = delete;
+    AlignedBufferPool& operator=(const AlignedBufferPool&) = delete;
+
+    // 至少bytes字节的对齐缓冲区，长度按块向上取整
+    Buffer acquire(size_t bytes) {
+        if (bytes <= bufferBytes) {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (!idle.empty()) {
+                    char* p = idle.back();
+                    idle.pop_back();
+                    return Buffer(this, p, bufferBytes);
+                }
+            }
+            return Buffer(this, allocate(bufferBytes), bufferBytes);
+        }
+        size_t len = roundUp(bytes);
+        return Buffer(this, allocate(len), len);
+    }
+
+    size_t alignment() const { return align; }
+
+    // 向上取整到块大小
+    size_t roundUp(size_t bytes) const { return (bytes + align - 1) & ~(align - 1); }
+
+private:
+    char* allocate(size_t len) {
+        void* p = nullptr;
+        if (posix_memalign(&p, align, len == 0 ? align : len) != 0) {
+            throw std::bad_alloc();
+        }
+        return static_cast<char*>(p);
+    }
+
+    void release(char* p, size_t len) {
+        if (len == bufferBytes) {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (idle.size() < maxPooled) {
+                idle.push_back(p);
+                return;
+            }
+        }
+        std::free(p);
+    }
+
+    size_t align;
+    size_t bufferBytes;
+    size_t maxPooled;
+    std::mutex mutex;
+    std::vector<char*> idle;   // 空闲缓冲区，受mutex保护
+};
+
+#endif // ALIGNED_BUFFER_POOL_H
@@ -0,0 +1,90 @@
+#include "ObjectStorage.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+// 内存分配计数测试：统计不同put/get路径每次操作的堆分配次数和负载大小的分配(即负载复制)次数
+// 用法: AllocBench [操作次数] [对象大小]
+
+static std::atomic<size_t> allocCount(0);
+static std::atomic<size_t> largeAllocCount(0);
+static size_t largeThreshold = static_cast<size_t>(-1);
+
+// 不内联，否则GCC在调用处看到malloc/free，按new/delete配对检查时告警
+__attribute__((noinline)) void* operator new(size_t size) {
+    allocCount.fetch_add(1, std::memory_order_relaxed);
+    if (size >= largeThreshold) largeAllocCount.fetch_add(1, std::memory_order_relaxed);
+    void* p = std::malloc(size ? size : 1);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+
+__attribute__((noinline)) void operator delete(void* p) noexcept { std::free(p); }
+__attribute__((noinline)) void operator delete(void* p, size_t) noexcept { std::free(p); }
+
+struct Counter {
+    size_t allocs;
+    size_t payloadAllocs;
+    Counter() : allocs(allocCount.load()), payloadAllocs(largeAllocCount.load()) {}
+    void report(const char* name, size_t ops) const {
+        std::cout << name << ": " << static_cast<double>(allocCount.load() - allocs) / ops << " allocs/op, "
+                  << static_cast<double>(largeAllocCount.load() - payloadAllocs) / ops << " payload copies/op"
+                  << std::endl;
+    }
+};
+
+int main(int argc, char* argv[]) {
+    size_t ops = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 100000;
+    size_t valueSize = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 4096;
+    const std::string path = "alloc_bench.dat";
+    const int keys = 1000;
+
+    ObjectStorage::destroy(path);
+    {
+        ObjectStorage storage(path, keys * 2 * LRUCache::charge(valueSize));
+        // 预先写入所有key，之后的put只走覆盖路径，不会新建元数据节点
+        for (int k = 0; k < keys; ++k) {
+            storage.put(k, std::vector<char>(valueSize, 'x'));
+        }
+
+        // 调用方准备的数据提前分配好，不计入统计
+        std::vector<std::vector<char>> values(ops, std::vector<char>(valueSize, 'y'));
+        largeThreshold = valueSize;
+
+        {
+            Counter c;
+            for (size_t i = 0; i < ops; ++i) storage.put(static_cast<int>(i % keys), values[i]);
+            c.report("put(const vector&)", ops);
+        }
+        {
+            Counter c;
+            for (size_t i = 0; i < ops; ++i) storage.put(static_cast<int>(i % keys), std::move(values[i]));
+            c.report("put(vector&&)     ", ops);
+        }
+        {
+            ValueRef shared = ValueRef::copyOf(std::vector<char>(valueSize, 'z').data(), valueSize);
+            Counter c;
+            for (size_t i = 0; i < ops; ++i) storage.put(static_cast<int>(i % keys), shared);
+            c.report("put(ValueRef)     ", ops);
+        }
+        {
+            Counter c;
+            size_t bytes = 0;
+            for (size_t i = 0; i < ops; ++i) bytes += storage.getRef(static_cast<int>(i % keys)).size();
+            c.report("getRef (hit)      ", ops);
+            if (bytes == 0) std::cout << "unexpected empty reads" << std::endl;
+        }
+        {
+            Counter c;
+            for (size_t i = 0; i < ops; ++i) storage.get(static_cast<int>(i % keys));
+            c.report("get (hit, copy)   ", ops);
+        }
+        largeThreshold = static_cast<size_t>(-1);
+    }
+
+    ObjectStorage::destroy(path);
+    return 0;
+}
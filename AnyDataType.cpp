@@ -5,7 +5,7 @@
 #include <stdexcept>
 #include <type_traits>
 
-// л
+// 序列化函数
 std::string serializeData(const AnyDataType& message) {
     std::string serialized_data;
     if (!message.SerializeToString(&serialized_data)) {
@@ -14,7 +14,7 @@ std::string serializeData(const AnyDataType& message) {
     return serialized_data;
 }
 
-// л
+// 反序列化函数
 AnyDataType deserializeData(const std::string& serialized_data) {
     AnyDataType message;
     if (!message.ParseFromString(serialized_data)) {
@@ -49,7 +49,7 @@ AnyDataType deserializeData(const std::string& serialized_data) {
 //     return message;
 // }
 
-// AnyDataTypeϢȡ
+// 从AnyDataType消息中提取数据
 // void unwrapData(const AnyDataType& message) {
 //     if (message.has_int_value()) {
 //         std::cout << "Int value: " << message.int_value() << std::endl;
@@ -73,7 +73,7 @@ AnyDataType deserializeData(const std::string& serialized_data) {
 // }
 
 int main() {
-    //  int64 
+    // 测试 int64 类型
     int32_t int32_data = 901234LL;
     std::cout << "test" << std::endl;
     AnyDataType int64_message = wrapData(int32_data);
@@ -0,0 +1,117 @@
+#include "ObjectStorage.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <fcntl.h>
+#include <mutex>
+#include <random>
+#include <unistd.h>
+
+// 异步I/O测试：单个线程在不同队列深度下发起未命中缓存的随机读，比较同步pread、
+// io_uring和线程池后端的吞吐；另外比较同步put和异步putAsync的写入吞吐
+// 每轮开始前丢弃页缓存，读取都落到设备上
+// 用法: AsyncBench [对象数量] [对象大小] [每轮读取次数]
+
+static void dropPageCache(const std::string& path) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) return;
+    fdatasync(fd);
+    posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+    close(fd);
+}
+
+static double seconds(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// 保持depth个请求在途，直到完成ops次读取
+static double readAsync(ObjectStorage& storage, int keys, size_t ops, unsigned depth) {
+    std::mutex mutex;
+    std::condition_variable cv;
+    unsigned inflight = 0;
+    std::mt19937 rng(5);
+    std::uniform_int_distribution<int> dist(0, keys - 1);
+
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < ops; ++i) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            cv.wait(lock, [&]() { return inflight < depth; });
+            ++inflight;
+        }
+        storage.getAsync(dist(rng), [&](ValueRef, std::exception_ptr) {
+            std::lock_guard<std::mutex> lock(mutex);
+            --inflight;
+            cv.notify_one();
+        });
+    }
+    std::unique_lock<std::mutex> lock(mutex);
+    cv.wait(lock, [&]() { return inflight == 0; });
+    return ops / seconds(start);
+}
+
+int main(int argc, char* argv[]) {
+    int keys = argc > 1 ? std::atoi(argv[1]) : 100000;
+    size_t valueSize = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 4096;
+    size_t ops = argc > 3 ? std::strtoull(argv[3], nullptr, 10) : 50000;
+    const std::string path = "async_bench.dat";
+
+    ObjectStorage::destroy(path);
+    ObjectStorage::Options options;
+    options.cacheBytes = 1 << 20;
+    options.backgroundCompaction = false;
+
+    std::vector<char> value(valueSize, 'x');
+    std::cout << "write mode ops/s" << std::endl;
+    {
+        ObjectStorage storage(path, options);
+        auto start = std::chrono::steady_clock::now();
+        for (int k = 0; k < keys; ++k) storage.put(k, value);
+        std::cout << "write put " << keys / seconds(start) << std::endl;
+    }
+    ObjectStorage::destroy(path);
+    {
+        ObjectStorage storage(path, options);
+        std::vector<std::future<void>> pending;
+        pending.reserve(keys);
+        auto start = std::chrono::steady_clock::now();
+        for (int k = 0; k < keys; ++k) pending.push_back(storage.putAsync(k, ValueRef::copyOf(value.data(), value.size())));
+        for (auto& f : pending) f.get();
+        double rate = keys / seconds(start);
+        ObjectStorage::WriteStats stats = storage.writeStats();
+        std::cout << "write putAsync " << rate << " (avg batch "
+                  << static_cast<double>(stats.records) / stats.batches << ")" << std::endl;
+    }
+
+    std::cout << "read backend depth ops/s" << std::endl;
+    {
+        for (const auto& file : ObjectStorage::storageFiles(path)) dropPageCache(file);
+        ObjectStorage storage(path, options);
+        std::mt19937 rng(5);
+        std::uniform_int_distribution<int> dist(0, keys - 1);
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < ops; ++i) storage.getRef(dist(rng));
+        std::cout << "read pread 1 " << ops / seconds(start) << std::endl;
+    }
+    for (auto backend : {AsyncIO::Backend::IoUring, AsyncIO::Backend::ThreadPool}) {
+        for (unsigned depth : {1u, 8u, 32u, 128u}) {
+            for (const auto& file : ObjectStorage::storageFiles(path)) dropPageCache(file);
+            options.ioBackend = backend;
+            options.ioQueueDepth = depth;
+            options.ioThreads = depth < 16 ? depth : 16;
+            try {
+                ObjectStorage storage(path, options);
+                double rate = readAsync(storage, keys, ops, depth);
+                std::cout << "read " << storage.ioBackendName() << " " << depth << " " << rate << std::endl;
+            } catch (const std::exception& e) {
+                std::cout << "read backend unavailable: " << e.what() << std::endl;
+                break;
+            }
+        }
+    }
+
+    ObjectStorage::destroy(path);
+    return 0;
+}
@@ -0,0 +1,304 @@
+#include "AsyncIO.h"
+
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// 一个在途请求，user_data指向它，完成后释放
+struct Operation {
+    AsyncIO::Callback cb;
+    std::vector<struct iovec> iov;   // readv/writev使用的iovec，在完成前保持有效
+};
+
+// io_uring实现：一个提交锁保护SQ，一个完成线程收割CQ并执行回调
+class IoUringIO : public AsyncIO {
+public:
+    explicit IoUringIO(unsigned queueDepth);
+    ~IoUringIO() override;
+
+    void read(int fd, char* buf, size_t len, uint64_t offset, Callback cb) override;
+    void writev(int fd, const struct iovec* iov, int count, uint64_t offset, Callback cb) override;
+    const char* name() const override { return "io_uring"; }
+
+private:
+    static int setup(unsigned entries, struct io_uring_params* p) {
+        return static_cast<int>(syscall(__NR_io_uring_setup, entries, p));
+    }
+    static int enter(int fd, unsigned toSubmit, unsigned minComplete, unsigned flags) {
+        return static_cast<int>(syscall(__NR_io_uring_enter, fd, toSubmit, minComplete, flags, nullptr, 0));
+    }
+
+    // 提交一个请求，在途请求达到上限时等待
+    void submit(uint8_t opcode, int fd, Operation* op, uint64_t offset);
+    void completionLoop();
+
+    int ringFd;
+    void* sqRing;
+    void* cqRing;
+    size_t sqRingSize;
+    size_t cqRingSize;
+    struct io_uring_sqe* sqes;
+    size_t sqesSize;
+
+    unsigned* sqTail;
+    unsigned* sqMask;
+    unsigned* sqArray;
+    unsigned* cqHead;
+    unsigned* cqTail;
+    unsigned* cqMask;
+    struct io_uring_cqe* cqes;
+
+    unsigned depth;          // 在途请求上限，不超过CQ容量，避免完成队列溢出
+    unsigned inflight;       // 受mutex保护
+    std::mutex mutex;        // 保护SQ和inflight
+    std::condition_variable slotCv;
+    std::thread completionThread;
+};
+
+IoUringIO::IoUringIO(unsigned queueDepth) : sqRing(MAP_FAILED), cqRing(MAP_FAILED), sqes(nullptr),
+                                            inflight(0) {
+    struct io_uring_params p;
+    std::memset(&p, 0, sizeof(p));
+    ringFd = setup(queueDepth, &p);
+    if (ringFd < 0) {
+        throw std::runtime_error("io_uring_setup失败");
+    }
+    depth = std::min(p.sq_entries, p.cq_entries);
+
+    sqRingSize = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+    cqRingSize = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+    bool singleMap = (p.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (singleMap) sqRingSize = cqRingSize = std::max(sqRingSize, cqRingSize);
+
+    sqRing = mmap(nullptr, sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_SQ_RING);
+    if (sqRing == MAP_FAILED) {
+        close(ringFd);
+        throw std::runtime_error("无法映射io_uring提交队列");
+    }
+    cqRing = singleMap ? sqRing
+        : mmap(nullptr, cqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_CQ_RING);
+    sqesSize = p.sq_entries * sizeof(struct io_uring_sqe);
+    void* sqeMap = mmap(nullptr, sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_SQES);
+    if (cqRing == MAP_FAILED || sqeMap == MAP_FAILED) {
+        if (cqRing != MAP_FAILED && !singleMap) munmap(cqRing, cqRingSize);
+        if (sqeMap != MAP_FAILED) munmap(sqeMap, sqesSize);
+        munmap(sqRing, sqRingSize);
+        close(ringFd);
+        throw std::runtime_error("无法映射io_uring队列");
+    }
+    sqes = static_cast<struct io_uring_sqe*>(sqeMap);
+
+    char* sq = static_cast<char*>(sqRing);
+    sqTail = reinterpret_cast<unsigned*>(sq + p.sq_off.tail);
+    sqMask = reinterpret_cast<unsigned*>(sq + p.sq_off.ring_mask);
+    sqArray = reinterpret_cast<unsigned*>(sq + p.sq_off.array);
+    char* cq = static_cast<char*>(cqRing);
+    cqHead = reinterpret_cast<unsigned*>(cq + p.cq_off.head);
+    cqTail = reinterpret_cast<unsigned*>(cq + p.cq_off.tail);
+    cqMask = reinterpret_cast<unsigned*>(cq + p.cq_off.ring_mask);
+    cqes = reinterpret_cast<struct io_uring_cqe*>(cq + p.cq_off.cqes);
+
+    completionThread = std::thread(&IoUringIO::completionLoop, this);
+}
+
+IoUringIO::~IoUringIO() {
+    {
+        // 等待在途请求完成，再用一个NOP唤醒完成线程退出
+        std::unique_lock<std::mutex> lock(mutex);
+        slotCv.wait(lock, [this]() { return inflight == 0; });
+    }
+    submit(IORING_OP_NOP, -1, nullptr, 0);
+    completionThread.join();
+
+    munmap(sqes, sqesSize);
+    if (cqRing != sqRing) munmap(cqRing, cqRingSize);
+    munmap(sqRing, sqRingSize);
+    close(ringFd);
+}
+
+void IoUringIO::submit(uint8_t opcode, int fd, Operation* op, uint64_t offset) {
+    std::unique_lock<std::mutex> lock(mutex);
+    if (op) {
+        slotCv.wait(lock, [this]() { return inflight < depth; });
+        ++inflight;
+    }
+
+    // 只有持有mutex的线程写SQ尾部，内核只推进头部
+    unsigned tail = *sqTail;
+    unsigned index = tail & *sqMask;
+    struct io_uring_sqe* sqe = &sqes[index];
+    std::memset(sqe, 0, sizeof(*sqe));
+    sqe->opcode = opcode;
+    sqe->fd = fd;
+    sqe->off = offset;
+    if (op) {
+        sqe->addr = reinterpret_cast<uint64_t>(op->iov.data());
+        sqe->len = static_cast<uint32_t>(op->iov.size());
+    }
+    sqe->user_data = reinterpret_cast<uint64_t>(op);
+    sqArray[index] = index;
+    __atomic_store_n(sqTail, tail + 1, __ATOMIC_RELEASE);
+
+    int ret;
+    do {
+        ret = enter(ringFd, 1, 0, 0);
+    } while (ret < 0 && errno == EINTR);
+    if (ret < 0) {
+        // 提交失败时撤回SQE，由调用方处理错误
+        __atomic_store_n(sqTail, tail, __ATOMIC_RELEASE);
+        if (op) {
+            --inflight;
+            delete op;
+        }
+        throw std::runtime_error("io_uring_enter提交失败");
+    }
+}
+
+void IoUringIO::read(int fd, char* buf, size_t len, uint64_t offset, Callback cb) {
+    Operation* op = new Operation{std::move(cb), {{buf, len}}};
+    submit(IORING_OP_READV, fd, op, offset);
+}
+
+void IoUringIO::writev(int fd, const struct iovec* iov, int count, uint64_t offset, Callback cb) {
+    Operation* op = new Operation{std::move(cb), std::vector<struct iovec>(iov, iov + count)};
+    submit(IORING_OP_WRITEV, fd, op, offset);
+}
+
+void IoUringIO::completionLoop() {
+    while (true) {
+        int ret = enter(ringFd, 0, 1, IORING_ENTER_GETEVENTS);
+        if (ret < 0 && errno != EINTR) break;
+
+        unsigned head = *cqHead;
+        unsigned tail = __atomic_load_n(cqTail, __ATOMIC_ACQUIRE);
+        bool quit = false;
+        std::vector<std::pair<Operation*, int>> done;
+        while (head != tail) {
+            const struct io_uring_cqe& cqe = cqes[head & *cqMask];
+            Operation* op = reinterpret_cast<Operation*>(cqe.user_data);
+            if (op) {
+                done.emplace_back(op, cqe.res);
+            } else {
+                quit = true;
+            }
+            ++head;
+        }
+        __atomic_store_n(cqHead, head, __ATOMIC_RELEASE);
+
+        // 先释放在途名额再执行回调，回调中再次提交请求不会因为队列满而死锁
+        if (!done.empty()) {
+            std::lock_guard<std::mutex> lock(mutex);
+            inflight -= static_cast<unsigned>(done.size());
+            slotCv.notify_all();
+        }
+        for (auto& d : done) {
+            d.first->cb(d.second);
+            delete d.first;
+        }
+        if (quit) break;
+    }
+}
+
+// 线程池实现：工作线程从任务队列取请求执行pread/pwritev
+class ThreadPoolIO : public AsyncIO {
+public:
+    ThreadPoolIO(unsigned queueDepth, unsigned threads);
+    ~ThreadPoolIO() override;
+
+    void read(int fd, char* buf, size_t len, uint64_t offset, Callback cb) override;
+    void writev(int fd, const struct iovec* iov, int count, uint64_t offset, Callback cb) override;
+    const char* name() const override { return "threadpool"; }
+
+private:
+    void post(std::function<void()> task);
+    void workerLoop();
+
+    unsigned depth;
+    std::deque<std::function<void()>> tasks;
+    bool stopping;
+    std::mutex mutex;
+    std::condition_variable taskCv;
+    std::condition_variable slotCv;
+    std::vector<std::thread> workers;
+};
+
+ThreadPoolIO::ThreadPoolIO(unsigned queueDepth, unsigned threads) : depth(queueDepth), stopping(false) {
+    if (threads == 0) threads = 1;
+    for (unsigned i = 0; i < threads; ++i) {
+        workers.emplace_back(&ThreadPoolIO::workerLoop, this);
+    }
+}
+
+ThreadPoolIO::~ThreadPoolIO() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    taskCv.notify_all();
+    for (auto& w : workers) w.join();
+}
+
+void ThreadPoolIO::post(std::function<void()> task) {
+    std::unique_lock<std::mutex> lock(mutex);
+    slotCv.wait(lock, [this]() { return tasks.size() < depth; });
+    tasks.push_back(std::move(task));
+    taskCv.notify_one();
+}
+
+void ThreadPoolIO::workerLoop() {
+    while (true) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            // 退出前先执行完队列中剩余的请求
+            taskCv.wait(lock, [this]() { return stopping || !tasks.empty(); });
+            if (tasks.empty()) return;
+            task = std::move(tasks.front());
+            tasks.pop_front();
+            slotCv.notify_one();
+        }
+        task();
+    }
+}
+
+void ThreadPoolIO::read(int fd, char* buf, size_t len, uint64_t offset, Callback cb) {
+    post([=]() {
+        ssize_t n = pread(fd, buf, len, offset);
+        cb(n < 0 ? -errno : n);
+    });
+}
+
+void ThreadPoolIO::writev(int fd, const struct iovec* iov, int count, uint64_t offset, Callback cb) {
+    std::vector<struct iovec> vec(iov, iov + count);
+    post([=]() {
+        ssize_t n = pwritev(fd, vec.data(), static_cast<int>(vec.size()), offset);
+        cb(n < 0 ? -errno : n);
+    });
+}
+
+} // namespace
+
+std::unique_ptr<AsyncIO> AsyncIO::create(Backend backend, unsigned queueDepth, unsigned threads) {
+    if (backend != Backend::ThreadPool) {
+        try {
+            return std::unique_ptr<AsyncIO>(new IoUringIO(queueDepth));
+        } catch (const std::exception&) {
+            if (backend == Backend::IoUring) throw;
+        }
+    }
+    return std::unique_ptr<AsyncIO>(new ThreadPoolIO(queueDepth, threads));
+}
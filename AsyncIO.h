@@ -0,0 +1,38 @@
+#ifndef ASYNC_IO_H
+#define ASYNC_IO_H
+
+#include <functional>
+#include <memory>
+#include <cstdint>
+#include <sys/types.h>
+#include <sys/uio.h>
+
+// 异步文件I/O：提交后立即返回，完成时在后台线程调用回调
+// 两种实现：io_uring(直接使用系统调用，不依赖liburing)和线程池+pread/pwritev；
+// io_uring不可用(内核过旧或被禁止)时自动退回线程池
+class AsyncIO {
+public:
+    enum class Backend {
+        Auto,          // 优先io_uring，不可用时使用线程池
+        IoUring,
+        ThreadPool,
+    };
+
+    // 完成回调，参数为传输的字节数，失败时为-errno；回调在完成线程上执行，不应长时间阻塞
+    using Callback = std::function<void(ssize_t result)>;
+
+    virtual ~AsyncIO() {}
+
+    // 从offset读取len字节到buf，buf在回调之前必须保持有效
+    virtual void read(int fd, char* buf, size_t len, uint64_t offset, Callback cb) = 0;
+
+    // 把一组iovec写到offset，iovec数组会被复制，指向的数据在回调之前必须保持有效
+    virtual void writev(int fd, const struct iovec* iov, int count, uint64_t offset, Callback cb) = 0;
+
+    virtual const char* name() const = 0;
+
+    // queueDepth为同时在途的请求上限，threads为线程池实现的线程数
+    static std::unique_ptr<AsyncIO> create(Backend backend, unsigned queueDepth, unsigned threads);
+};
+
+#endif // ASYNC_IO_H
@@ -0,0 +1,100 @@
+#ifndef BLOOM_FILTER_H
+#define BLOOM_FILTER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "FlatHashMap.h"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+// 分块Bloom过滤器(split block)：每个key只落在一个32字节的块里，块内8个32位字各置1位，
+// 一次查询只访问一条缓存行；8个字的掩码互相独立，SSE2下用两次128位比较完成
+// 只能加入不能删除，已删除的key留下的位在重建时清除
+class BloomFilter {
+public:
+    static const size_t kBlockWords = 8;
+
+    struct alignas(32) Block {
+        uint32_t words[kBlockWords];
+    };
+
+    // 未分配的过滤器不排除任何key
+    BloomFilter() : keys(0) {}
+
+    // 按keys个key、每个key bitsPerKey位分配，至少一个块
+    BloomFilter(size_t keys, unsigned bitsPerKey) : keys(keys) {
+        size_t bits = keys * bitsPerKey;
+        size_t count = (bits + 8 * sizeof(Block) - 1) / (8 * sizeof(Block));
+        blocks.assign(count == 0 ? 1 : count, Block());
+    }
+
+    void add(int key) {
+        uint64_t h = FlatHash()(key);
+        uint32_t mask[kBlockWords];
+        makeMask(static_cast<uint32_t>(h), mask);
+        Block& b = blocks[blockOf(h)];
+        for (size_t i = 0; i < kBlockWords; ++i) b.words[i] |= mask[i];
+    }
+
+    // 返回false时key一定没有加入过
+    bool mayContain(int key) const {
+        if (blocks.empty()) return true;
+        uint64_t h = FlatHash()(key);
+        alignas(16) uint32_t mask[kBlockWords];
+        makeMask(static_cast<uint32_t>(h), mask);
+        const Block& b = blocks[blockOf(h)];
+#ifdef __SSE2__
+        // (块 & 掩码) == 掩码，即 ~块 & 掩码 全为0
+        const __m128i* w = reinterpret_cast<const __m128i*>(b.words);
+        const __m128i* m = reinterpret_cast<const __m128i*>(mask);
+        __m128i miss = _mm_or_si128(_mm_andnot_si128(_mm_load_si128(w), _mm_load_si128(m)),
+                                    _mm_andnot_si128(_mm_load_si128(w + 1), _mm_load_si128(m + 1)));
+        return _mm_movemask_epi8(_mm_cmpeq_epi8(miss, _mm_setzero_si128())) == 0xffff;
+#else
+        uint32_t miss = 0;
+        for (size_t i = 0; i < kBlockWords; ++i) miss |= mask[i] & ~b.words[i];
+        return miss == 0;
+#endif
+    }
+
+    // 分配时预期的key数
+    size_t capacity() const { return keys; }
+    size_t memoryBytes() const { return blocks.size() * sizeof(Block); }
+
+    // 持久化用：块数组的原始内容
+    const char* data() const { return reinterpret_cast<const char*>(blocks.data()); }
+    size_t blockCount() const { return blocks.size(); }
+
+    // 从持久化的块数组恢复，data不要求对齐
+    static BloomFilter fromBlocks(size_t keys, const char* data, size_t count) {
+        BloomFilter f;
+        f.keys = keys;
+        f.blocks.resize(count);
+        std::memcpy(f.blocks.data(), data, count * sizeof(Block));
+        return f;
+    }
+
+private:
+    // 高32位选块(乘法取范围，块数不必是2的幂)，低32位乘以8个奇数常量后取高5位作为各字中的位
+    size_t blockOf(uint64_t h) const {
+        return static_cast<size_t>(((h >> 32) * blocks.size()) >> 32);
+    }
+
+    static void makeMask(uint32_t h, uint32_t* mask) {
+        static const uint32_t kSalt[kBlockWords] = {
+            0x47b6137bu, 0x44974d91u, 0x8824ad5bu, 0xa2b7289du,
+            0x705495c7u, 0x2df1424bu, 0x9efc4947u, 0x5c6bfb31u,
+        };
+        for (size_t i = 0; i < kBlockWords; ++i) mask[i] = 1u << ((h * kSalt[i]) >> 27);
+    }
+
+    size_t keys;
+    std::vector<Block> blocks;
+};
+
+#endif // BLOOM_FILTER_H
@@ -0,0 +1,66 @@
+#include "LRUCache.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <random>
+#include <thread>
+
+// 缓存并发测试：不同线程数下命中/未命中场景的吞吐，对比单分片(单锁)和多分片
+// 用法: CacheBench [最大线程数] [每线程操作数] [缓存条目数]
+
+static double run(LRUCache& cache, size_t threads, size_t ops, int keySpace) {
+    std::atomic<bool> go(false);
+    std::vector<std::thread> workers;
+    for (size_t t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t]() {
+            std::mt19937 rng(static_cast<uint32_t>(t + 1));
+            std::uniform_int_distribution<int> dist(0, keySpace - 1);
+            std::vector<char> value(16, 'v');
+            while (!go.load()) {}
+            for (size_t i = 0; i < ops; ++i) {
+                int key = dist(rng);
+                if (cache.get(key).empty()) {
+                    cache.put(key, value);  // 未命中时回填
+                }
+            }
+        });
+    }
+    auto start = std::chrono::steady_clock::now();
+    go.store(true);
+    for (auto& w : workers) w.join();
+    double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return threads * ops / sec / 1e6;
+}
+
+int main(int argc, char* argv[]) {
+    size_t maxThreads = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : std::thread::hardware_concurrency();
+    size_t ops = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 1000000;
+    size_t capacity = argc > 3 ? std::strtoull(argv[3], nullptr, 10) : 100000;
+    if (maxThreads == 0) maxThreads = 1;
+
+    struct Scenario {
+        const char* name;
+        int keySpace;
+    };
+    Scenario scenarios[] = {
+        {"hit", static_cast<int>(capacity / 2)},    // 全部命中
+        {"miss", static_cast<int>(capacity * 10)},  // 约90%未命中
+    };
+
+    std::cout << "scenario shards threads Mops/s" << std::endl;
+    for (const auto& sc : scenarios) {
+        for (size_t shardCount : {static_cast<size_t>(1), static_cast<size_t>(64)}) {
+            for (size_t threads = 1; threads <= maxThreads; threads *= 2) {
+                LRUCache cache(capacity * LRUCache::charge(16), shardCount);
+                std::vector<char> value(16, 'v');
+                for (int k = 0; k < sc.keySpace && static_cast<size_t>(k) < capacity; ++k) {
+                    cache.put(k, value);
+                }
+                double mops = run(cache, threads, ops, sc.keySpace);
+                std::cout << sc.name << " " << cache.shardCount() << " " << threads << " " << mops << std::endl;
+            }
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,124 @@
+#include "ObjectStorage.h"
+#include "RateLimiter.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <thread>
+
+// 压缩测试：覆盖写产生垃圾后执行压缩，报告空间放大以及压缩期间前台读写的延迟
+// 对比不压缩、不限速压缩、限速压缩三种情况；前台负载固定为每秒20000次操作(10%写)
+// 日志段为8MB，压缩逐段进行；最后重新打开存储校验数据
+// 用法: CompactionBench [对象数量] [对象大小] [限速MB/s]
+
+static std::vector<char> makeValue(int key, int round, size_t size) {
+    std::vector<char> value(size, static_cast<char>('a' + round % 26));
+    std::memcpy(value.data(), &key, std::min(size, sizeof(key)));
+    return value;
+}
+
+static double amplification(ObjectStorage& storage) {
+    ObjectStorage::SpaceStats s = storage.spaceStats();
+    return s.liveBytes ? static_cast<double>(s.fileBytes) / s.liveBytes : 0;
+}
+
+int main(int argc, char* argv[]) {
+    int keys = argc > 1 ? std::atoi(argv[1]) : 100000;
+    size_t valueSize = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 1024;
+    uint64_t rateMB = argc > 3 ? std::strtoull(argv[3], nullptr, 10) : 32;
+    const int rounds = 3;
+    const std::string path = "compaction_bench.dat";
+
+    ObjectStorage::destroy(path);
+
+    ObjectStorage::Options options;
+    options.cacheBytes = 1 << 20;
+    options.segmentBytes = 8 << 20;
+    options.backgroundCompaction = false;
+    std::unique_ptr<ObjectStorage> db(new ObjectStorage(path, options));
+    ObjectStorage& storage = *db;
+
+    int round = 0;
+    auto overwriteAll = [&]() {
+        for (int r = 0; r < rounds; ++r, ++round) {
+            for (int k = 0; k < keys; ++k) storage.put(k, makeValue(k, round, valueSize));
+        }
+    };
+
+    struct Scenario {
+        const char* name;
+        bool compact;
+        uint64_t rate;
+    };
+    Scenario scenarios[] = {
+        {"no compaction", false, 0},
+        {"unthrottled", true, 0},
+        {"throttled", true, rateMB << 20},
+    };
+
+    std::cout << "scenario amp_before amp_after segments compact_ms p50_us p99_us max_us" << std::endl;
+    for (const auto& sc : scenarios) {
+        overwriteAll();
+        double before = amplification(storage);
+
+        // 前台线程随机读写并记录延迟，后台同时执行压缩
+        std::atomic<bool> done(false);
+        std::vector<double> latencies;
+        std::thread foreground([&]() {
+            std::mt19937 rng(7);
+            std::uniform_int_distribution<int> dist(0, keys - 1);
+            RateLimiter pace(20000);
+            for (size_t i = 0; !done.load() || i < 20000; ++i) {
+                pace.acquire(1);
+                int key = dist(rng);
+                auto start = std::chrono::steady_clock::now();
+                if (i % 10 == 0) {
+                    storage.put(key, makeValue(key, round - 1, valueSize));
+                } else {
+                    storage.get(key);
+                }
+                latencies.push_back(std::chrono::duration<double, std::micro>(
+                    std::chrono::steady_clock::now() - start).count());
+            }
+        });
+
+        double compactMs = 0;
+        if (sc.compact) {
+            storage.setCompactionRateLimit(sc.rate);
+            auto start = std::chrono::steady_clock::now();
+            storage.compact();
+            compactMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        }
+        done.store(true);
+        foreground.join();
+
+        std::sort(latencies.begin(), latencies.end());
+        double p50 = latencies[latencies.size() / 2];
+        double p99 = latencies[latencies.size() * 99 / 100];
+        std::cout << sc.name << " " << before << " " << amplification(storage) << " "
+                  << storage.spaceStats().segments << " " << compactMs
+                  << " " << p50 << " " << p99 << " " << latencies.back() << std::endl;
+    }
+
+    // 校验压缩后的数据，以及重新打开后从索引恢复的数据
+    auto verify = [&](ObjectStorage& s) {
+        size_t bad = 0;
+        for (int k = 0; k < keys; ++k) {
+            if (s.get(k) != makeValue(k, round - 1, valueSize)) ++bad;
+        }
+        return bad;
+    };
+    size_t bad = verify(storage);
+    db.reset(new ObjectStorage(path, options));
+    bad += verify(*db);
+    std::cout << "verify: " << (bad == 0 ? "ok" : "FAILED") << " (" << bad << " mismatches)" << std::endl;
+
+    db.reset();
+    ObjectStorage::destroy(path);
+    return bad == 0 ? 0 : 1;
+}
@@ -0,0 +1,75 @@
+#include "ObjectStorage.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <thread>
+
+// 并发读测试：多线程get(大部分未命中缓存，走pread)，可选一个后台写线程持续put
+// 用法: ConcurrentGetBench [最大线程数] [对象数量] [每线程操作数]
+
+static double run(ObjectStorage& storage, size_t threads, size_t ops, int keys, bool withWriter) {
+    std::atomic<bool> go(false);
+    std::atomic<bool> stop(false);
+    std::vector<std::thread> readers;
+    for (size_t t = 0; t < threads; ++t) {
+        readers.emplace_back([&, t]() {
+            std::mt19937 rng(static_cast<uint32_t>(t + 1));
+            std::uniform_int_distribution<int> dist(0, keys - 1);
+            while (!go.load()) {}
+            for (size_t i = 0; i < ops; ++i) {
+                storage.get(dist(rng));
+            }
+        });
+    }
+    std::thread writer;
+    if (withWriter) {
+        writer = std::thread([&]() {
+            std::vector<char> value(100, 'w');
+            int key = 0;
+            while (!go.load()) {}
+            while (!stop.load()) {
+                storage.put(key, value);
+                key = (key + 1) % keys;
+            }
+        });
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    go.store(true);
+    for (auto& r : readers) r.join();
+    double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    stop.store(true);
+    if (writer.joinable()) writer.join();
+    return threads * ops / sec / 1e6;
+}
+
+int main(int argc, char* argv[]) {
+    size_t maxThreads = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : std::thread::hardware_concurrency();
+    int keys = argc > 2 ? std::atoi(argv[2]) : 200000;
+    size_t ops = argc > 3 ? std::strtoull(argv[3], nullptr, 10) : 200000;
+    if (maxThreads == 0) maxThreads = 1;
+    const std::string path = "concurrent_get_bench.dat";
+
+    ObjectStorage::destroy(path);
+    {
+        ObjectStorage storage(path, 256 << 10);  // 缓存远小于数据量，大部分读走磁盘
+        std::vector<char> value(100, 'x');
+        for (int i = 0; i < keys; ++i) {
+            storage.put(i, value);
+        }
+
+        std::cout << "writer threads Mops/s" << std::endl;
+        for (bool withWriter : {false, true}) {
+            for (size_t threads = 1; threads <= maxThreads; threads *= 2) {
+                double mops = run(storage, threads, ops, keys, withWriter);
+                std::cout << (withWriter ? "yes" : "no") << " " << threads << " " << mops << std::endl;
+            }
+        }
+    }
+
+    ObjectStorage::destroy(path);
+    return 0;
+}
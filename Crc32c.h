@@ -0,0 +1,81 @@
+#ifndef CRC32C_H
+#define CRC32C_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+// CRC32C (Castagnoli) 校验，用于索引文件和数据记录
+namespace crc32c {
+
+struct Table {
+    uint32_t t[256];
+    Table() {
+        for (uint32_t i = 0; i < 256; ++i) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; ++k) {
+                c = (c & 1) ? (c >> 1) ^ 0x82F63B78u : (c >> 1);
+            }
+            t[i] = c;
+        }
+    }
+};
+
+inline const uint32_t* table() {
+    static const Table tbl;
+    return tbl.t;
+}
+
+// 软件实现，逐字节查表
+inline uint32_t extendSoftware(uint32_t crc, const char* data, size_t len) {
+    const uint32_t* tbl = table();
+    const unsigned char* p = reinterpret_cast<const unsigned char*>(data);
+    crc = ~crc;
+    for (size_t i = 0; i < len; ++i) {
+        crc = tbl[(crc ^ p[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+#if defined(__x86_64__) && defined(__GNUC__)
+// SSE4.2 硬件指令实现，每次处理8字节
+__attribute__((target("sse4.2")))
+inline uint32_t extendHardware(uint32_t crc, const char* data, size_t len) {
+    uint64_t c = ~crc;
+    while (len >= 8) {
+        uint64_t v;
+        std::memcpy(&v, data, 8);
+        c = __builtin_ia32_crc32di(c, v);
+        data += 8;
+        len -= 8;
+    }
+    uint32_t c32 = static_cast<uint32_t>(c);
+    while (len > 0) {
+        c32 = __builtin_ia32_crc32qi(c32, static_cast<unsigned char>(*data));
+        ++data;
+        --len;
+    }
+    return ~c32;
+}
+
+inline bool hasHardware() {
+    static const bool supported = __builtin_cpu_supports("sse4.2");
+    return supported;
+}
+#endif
+
+// 在已有crc的基础上继续计算
+inline uint32_t extend(uint32_t crc, const char* data, size_t len) {
+#if defined(__x86_64__) && defined(__GNUC__)
+    if (hasHardware()) return extendHardware(crc, data, len);
+#endif
+    return extendSoftware(crc, data, len);
+}
+
+inline uint32_t value(const char* data, size_t len) {
+    return extend(0, data, len);
+}
+
+} // namespace crc32c
+
+#endif // CRC32C_H
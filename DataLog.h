@@ -0,0 +1,148 @@
+#ifndef DATA_LOG_H
+#define DATA_LOG_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "Crc32c.h"
+
+// 数据文件的记录格式: [RecordHeader][value bytes]
+// 非int键的记录为 [RecordHeader][key bytes][value bytes]，key字段是键的字节数，length包含键
+// 每条记录自描述，可以不依赖索引顺序扫描恢复
+namespace datalog {
+
+enum Flags : uint8_t {
+    FLAG_PUT = 1,
+    FLAG_TOMBSTONE = 2,
+};
+
+struct RecordHeader {
+    uint32_t crc;         // 头部其余字段和value的CRC32C
+    uint8_t flags;        // FLAG_PUT / FLAG_TOMBSTONE
+    uint8_t reserved[3];
+    int32_t key;          // 对象Key
+    uint32_t length;      // value长度
+};
+
+static_assert(sizeof(RecordHeader) == 16, "RecordHeader must be 16 bytes");
+
+inline uint32_t checksum(const RecordHeader& header, const char* value) {
+    uint32_t crc = crc32c::value(reinterpret_cast<const char*>(&header) + sizeof(header.crc),
+                                 sizeof(RecordHeader) - sizeof(header.crc));
+    return crc32c::extend(crc, value, header.length);
+}
+
+inline RecordHeader makeHeader(uint8_t flags, int key, const char* value, uint32_t length) {
+    RecordHeader header;
+    std::memset(&header, 0, sizeof(header));
+    header.flags = flags;
+    header.key = key;
+    header.length = length;
+    header.crc = checksum(header, value);
+    return header;
+}
+
+// 键的字节在value之前，两段不必连续，CRC依次覆盖两段
+inline RecordHeader makeHeader(uint8_t flags, int key, const char* keyBytes, uint32_t keyLength,
+                               const char* value, uint32_t length) {
+    RecordHeader header;
+    std::memset(&header, 0, sizeof(header));
+    header.flags = flags;
+    header.key = key;
+    header.length = keyLength + length;
+    uint32_t crc = crc32c::value(reinterpret_cast<const char*>(&header) + sizeof(header.crc),
+                                 sizeof(RecordHeader) - sizeof(header.crc));
+    crc = crc32c::extend(crc, keyBytes, keyLength);
+    header.crc = crc32c::extend(crc, value, length);
+    return header;
+}
+
+// 顺序扫描数据文件，使用大块缓冲读取
+class LogScanner {
+public:
+    explicit LogScanner(const std::string& path, size_t bufferSize = 4 << 20)
+        : path(path), buffer(bufferSize) {}
+
+    // 从start开始扫描，每条有效记录调用 fn(header, valueOffset, valuePtr)
+    // 遇到校验失败或不完整的记录即停止，返回最后一条有效记录的结束位置
+    template <typename Fn>
+    uint64_t scan(uint64_t start, Fn fn);
+
+private:
+    // 把未处理的数据移到缓冲区开头并继续读满，返回是否读到新数据
+    bool refill(int fd, size_t& pos, size_t& len, uint64_t& bufOffset);
+
+    std::string path;
+    std::vector<char> buffer;
+};
+
+inline bool LogScanner::refill(int fd, size_t& pos, size_t& len, uint64_t& bufOffset) {
+    size_t remain = len - pos;
+    if (pos > 0) {
+        std::memmove(buffer.data(), buffer.data() + pos, remain);
+        bufOffset += pos;
+        pos = 0;
+        len = remain;
+    }
+    if (len == buffer.size()) return false;
+    ssize_t n = pread(fd, buffer.data() + len, buffer.size() - len, bufOffset + len);
+    if (n <= 0) return false;
+    len += static_cast<size_t>(n);
+    return true;
+}
+
+template <typename Fn>
+uint64_t LogScanner::scan(uint64_t start, Fn fn) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) return start;
+    posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+    struct stat st;
+    uint64_t fileSize = fstat(fd, &st) == 0 ? static_cast<uint64_t>(st.st_size) : 0;
+
+    uint64_t bufOffset = start;  // buffer[0] 对应的文件偏移
+    size_t pos = 0;
+    size_t len = 0;
+    uint64_t validEnd = start;
+
+    while (true) {
+        if (len - pos < sizeof(RecordHeader) && !refill(fd, pos, len, bufOffset)) break;
+        if (len - pos < sizeof(RecordHeader)) continue;
+
+        RecordHeader header;
+        std::memcpy(&header, buffer.data() + pos, sizeof(header));
+        if (header.flags != FLAG_PUT && header.flags != FLAG_TOMBSTONE) break;
+
+        // 长度超出文件剩余部分的是残缺或损坏的尾部记录，先判断再按长度扩大缓冲区
+        if (header.length > fileSize - (bufOffset + pos) - sizeof(RecordHeader)) break;
+        size_t recordSize = sizeof(RecordHeader) + header.length;
+        if (recordSize > buffer.size()) {
+            // 大对象超过缓冲区，扩大缓冲区
+            buffer.resize(recordSize);
+        }
+        if (len - pos < recordSize) {
+            if (!refill(fd, pos, len, bufOffset)) break;
+            continue;
+        }
+
+        const char* value = buffer.data() + pos + sizeof(RecordHeader);
+        if (header.crc != checksum(header, value)) break;
+
+        uint64_t recordOffset = bufOffset + pos;
+        fn(header, recordOffset + sizeof(RecordHeader), value);
+        pos += recordSize;
+        validEnd = recordOffset + recordSize;
+    }
+
+    close(fd);
+    return validEnd;
+}
+
+} // namespace datalog
+
+#endif // DATA_LOG_H
@@ -0,0 +1,93 @@
+#include "ObjectStorage.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <fcntl.h>
+#include <random>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// O_DIRECT测试：比较缓冲I/O和directIO模式的写入吞吐、随机读吞吐，以及数据文件在页缓存中的驻留量
+// 读取集中在工作集上，缓存按工作集大小设置：缓冲I/O下热数据同时留在LRU缓存和页缓存里，
+// directIO模式下只有LRU缓存持有数据
+// 用法: DirectBench [对象数量] [对象大小] [工作集比例] [读取次数]
+
+static void dropPageCache(const std::string& path) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) return;
+    fdatasync(fd);
+    posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+    close(fd);
+}
+
+// 用mincore统计文件在页缓存中驻留的字节数
+static uint64_t residentBytes(const std::string& path) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) return 0;
+    struct stat st;
+    uint64_t resident = 0;
+    if (fstat(fd, &st) == 0 && st.st_size > 0) {
+        size_t page = static_cast<size_t>(sysconf(_SC_PAGE_SIZE));
+        void* addr = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+        if (addr != MAP_FAILED) {
+            std::vector<unsigned char> vec((st.st_size + page - 1) / page);
+            if (mincore(addr, st.st_size, vec.data()) == 0) {
+                for (unsigned char v : vec) resident += (v & 1) ? page : 0;
+            }
+            munmap(addr, st.st_size);
+        }
+    }
+    close(fd);
+    return resident;
+}
+
+static double seconds(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char* argv[]) {
+    int keys = argc > 1 ? std::atoi(argv[1]) : 200000;
+    size_t valueSize = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 1024;
+    double fraction = argc > 3 ? std::atof(argv[3]) : 0.1;
+    size_t reads = argc > 4 ? std::strtoull(argv[4], nullptr, 10) : 500000;
+    const std::string path = "direct_bench.dat";
+    int workingSet = std::max(1, static_cast<int>(keys * fraction));
+
+    std::cout << "data: " << keys << " keys, value size " << valueSize << ", working set " << workingSet << std::endl;
+    std::cout << "mode write_ops/s read_ops/s cache_hit% cache_MB pagecache_MB" << std::endl;
+    for (bool direct : {false, true}) {
+        ObjectStorage::destroy(path);
+        ObjectStorage::Options options;
+        options.cacheBytes = LRUCache::charge(valueSize) * workingSet * 11 / 10;
+        options.backgroundCompaction = false;
+        options.directIO = direct;
+
+        std::vector<char> value(valueSize, 'x');
+        double writeRate;
+        {
+            ObjectStorage storage(path, options);
+            auto start = std::chrono::steady_clock::now();
+            for (int k = 0; k < keys; ++k) storage.put(k, value);
+            writeRate = keys / seconds(start);
+        }
+        for (const auto& file : ObjectStorage::storageFiles(path)) dropPageCache(file);
+
+        ObjectStorage storage(path, options);
+        std::mt19937 rng(9);
+        std::uniform_int_distribution<int> dist(0, workingSet - 1);
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < reads; ++i) storage.getRef(dist(rng));
+        double readRate = reads / seconds(start);
+
+        LRUCache::Stats stats = storage.cacheStats();
+        uint64_t pageCache = 0;
+        for (const auto& file : ObjectStorage::storageFiles(path)) pageCache += residentBytes(file);
+        std::cout << (direct ? "direct " : "buffered ") << writeRate << " " << readRate << " "
+                  << 100.0 * stats.hits / (stats.hits + stats.misses) << " "
+                  << stats.residentBytes / 1048576.0 << " " << pageCache / 1048576.0 << std::endl;
+    }
+
+    ObjectStorage::destroy(path);
+    return 0;
+}
@@ -0,0 +1,189 @@
+#include "EvictionPolicy.h"
+
+#include "Hash.h"
+
+const char* cachePolicyName(CachePolicy policy) {
+    switch (policy) {
+    case CachePolicy::LRU: return "LRU";
+    case CachePolicy::SLRU: return "SLRU";
+    case CachePolicy::TinyLFU: return "TinyLFU";
+    }
+    return "unknown";
+}
+
+std::unique_ptr<EvictionPolicy> EvictionPolicy::create(CachePolicy policy, size_t capacityBytes) {
+    switch (policy) {
+    case CachePolicy::SLRU: return std::unique_ptr<EvictionPolicy>(new SLRUPolicy(capacityBytes));
+    case CachePolicy::TinyLFU: return std::unique_ptr<EvictionPolicy>(new TinyLFUPolicy(capacityBytes));
+    case CachePolicy::LRU: break;
+    }
+    return std::unique_ptr<EvictionPolicy>(new LRUPolicy());
+}
+
+// LRUPolicy
+void LRUPolicy::onUpdate(CacheEntry& e, size_t oldCharge) {
+    queue.resize(oldCharge, e.charge);
+    queue.moveToFront(&e);
+}
+
+// SLRUPolicy
+SLRUPolicy::SLRUPolicy(size_t capacityBytes) : protectedCapacity(capacityBytes / 5 * 4) {}
+
+EntryQueue& SLRUPolicy::queueOf(CacheEntry& e) {
+    return e.segment == PROTECTED ? protectedQueue : probation;
+}
+
+void SLRUPolicy::demoteOverflow() {
+    while (protectedQueue.bytes() > protectedCapacity && !protectedQueue.empty()) {
+        CacheEntry* last = protectedQueue.back();
+        protectedQueue.remove(last);
+        last->segment = PROBATION;
+        probation.pushFront(last);
+    }
+}
+
+void SLRUPolicy::onInsert(CacheEntry& e) {
+    e.segment = PROBATION;
+    probation.pushFront(&e);
+}
+
+void SLRUPolicy::onHit(CacheEntry& e) {
+    e.fresh = false;
+    if (e.segment == PROTECTED) {
+        protectedQueue.moveToFront(&e);
+        return;
+    }
+    // 试用段再次命中，晋升到保护段
+    probation.remove(&e);
+    e.segment = PROTECTED;
+    protectedQueue.pushFront(&e);
+    demoteOverflow();
+}
+
+void SLRUPolicy::onUpdate(CacheEntry& e, size_t oldCharge) {
+    queueOf(e).resize(oldCharge, e.charge);
+    onHit(e);
+}
+
+void SLRUPolicy::onErase(CacheEntry& e) {
+    queueOf(e).remove(&e);
+}
+
+CacheEntry* SLRUPolicy::victim() {
+    return !probation.empty() ? probation.back() : protectedQueue.back();
+}
+
+void SLRUPolicy::forEach(const std::function<void(const CacheEntry&)>& fn) const {
+    protectedQueue.forEach(fn);
+    probation.forEach(fn);
+}
+
+// FrequencySketch
+FrequencySketch::FrequencySketch(size_t expectedEntries) : additions(0) {
+    width = 64;
+    while (width < expectedEntries) width *= 2;
+    counters.assign(kDepth * width, 0);
+    sampleSize = 10 * width;
+}
+
+size_t FrequencySketch::indexOf(int key, int row) const {
+    // 双重哈希生成每行的位置
+    uint32_t h1 = hashKey(key);
+    uint32_t h2 = hashKey(static_cast<int>(h1 ^ 0x9e3779b9u)) | 1;
+    return row * width + ((h1 + row * h2) & (width - 1));
+}
+
+void FrequencySketch::increment(int key) {
+    bool added = false;
+    for (int row = 0; row < kDepth; ++row) {
+        uint8_t& c = counters[indexOf(key, row)];
+        if (c < 15) {
+            ++c;
+            added = true;
+        }
+    }
+    if (added && ++additions >= sampleSize) {
+        reset();
+    }
+}
+
+uint32_t FrequencySketch::estimate(int key) const {
+    uint32_t freq = 15;
+    for (int row = 0; row < kDepth; ++row) {
+        uint32_t c = counters[indexOf(key, row)];
+        if (c < freq) freq = c;
+    }
+    return freq;
+}
+
+void FrequencySketch::reset() {
+    for (auto& c : counters) c >>= 1;
+    additions /= 2;
+}
+
+// TinyLFUPolicy
+TinyLFUPolicy::TinyLFUPolicy(size_t capacityBytes)
+    : SLRUPolicy(capacityBytes - capacityBytes / 100),
+      windowCapacity(capacityBytes / 100),
+      sketch(capacityBytes / 128) {}
+
+void TinyLFUPolicy::onInsert(CacheEntry& e) {
+    e.segment = WINDOW;
+    window.pushFront(&e);
+    // 窗口溢出的条目进入主区试用段，等待淘汰时的准入比较
+    while (window.bytes() > windowCapacity && window.back() != &e) {
+        CacheEntry* last = window.back();
+        window.remove(last);
+        last->segment = PROBATION;
+        last->fresh = true;
+        probation.pushFront(last);
+    }
+}
+
+void TinyLFUPolicy::onHit(CacheEntry& e) {
+    sketch.increment(e.key);
+    if (e.segment == WINDOW) {
+        window.moveToFront(&e);
+        return;
+    }
+    SLRUPolicy::onHit(e);
+}
+
+void TinyLFUPolicy::onUpdate(CacheEntry& e, size_t oldCharge) {
+    if (e.segment == WINDOW) {
+        window.resize(oldCharge, e.charge);
+        onHit(e);
+        return;
+    }
+    sketch.increment(e.key);
+    SLRUPolicy::onUpdate(e, oldCharge);
+}
+
+void TinyLFUPolicy::onErase(CacheEntry& e) {
+    if (e.segment == WINDOW) {
+        window.remove(&e);
+        return;
+    }
+    SLRUPolicy::onErase(e);
+}
+
+CacheEntry* TinyLFUPolicy::victim() {
+    if (probation.empty() && protectedQueue.empty()) {
+        return window.back();
+    }
+    CacheEntry* vict = SLRUPolicy::victim();
+    if (!probation.empty()) {
+        // 最近从窗口进入主区的条目与主区尾部比较频率，低者被淘汰
+        CacheEntry* candidate = probation.front();
+        if (candidate->fresh && candidate != vict) {
+            candidate->fresh = false;
+            return sketch.estimate(candidate->key) > sketch.estimate(vict->key) ? vict : candidate;
+        }
+    }
+    return vict;
+}
+
+void TinyLFUPolicy::forEach(const std::function<void(const CacheEntry&)>& fn) const {
+    window.forEach(fn);
+    SLRUPolicy::forEach(fn);
+}
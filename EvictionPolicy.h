@@ -0,0 +1,190 @@
+#ifndef EVICTION_POLICY_H
+#define EVICTION_POLICY_H
+
+#include <vector>
+#include <memory>
+#include <functional>
+#include <cstdint>
+
+#include "ValueRef.h"
+
+// 缓存淘汰策略，LRUCache的每个分片持有一个策略对象
+enum class CachePolicy {
+    LRU,        // 最近最少使用
+    SLRU,       // 分段LRU：试用段 + 保护段
+    TinyLFU,    // W-TinyLFU：窗口LRU + 频率草图准入 + 分段LRU主区
+};
+
+const char* cachePolicyName(CachePolicy policy);
+
+// 策略队列的链接，嵌在条目里，入队、出队和移动都不分配内存
+struct EntryLink {
+    EntryLink* prev;
+    EntryLink* next;
+};
+
+// 缓存条目，由分片的哈希表持有，策略用条目自带的链接把它串到自己的队列里
+struct CacheEntry : EntryLink {
+    int key;
+    ValueRef value;
+    size_t charge;        // 占用字节(含固定开销)
+    uint8_t segment;      // 所在队列，由策略解释
+    bool fresh;           // 刚从窗口进入主区，等待准入比较(W-TinyLFU)
+};
+
+// 按访问顺序排列的条目队列，表头最热，表尾最冷
+// 带哨兵的侵入式双向循环链表，哨兵的地址被条目引用，队列不能复制或移动
+class EntryQueue {
+public:
+    EntryQueue() : usage(0) { head.prev = head.next = &head; }
+
+    EntryQueue(const EntryQueue&) = delete;
+    EntryQueue& operator=(const EntryQueue&) = delete;
+
+    void pushFront(CacheEntry* e) {
+        link(e);
+        usage += e->charge;
+    }
+    void remove(CacheEntry* e) {
+        unlink(e);
+        usage -= e->charge;
+    }
+    void moveToFront(CacheEntry* e) {
+        if (head.next == e) return;
+        unlink(e);
+        link(e);
+    }
+    void resize(size_t oldCharge, size_t newCharge) { usage = usage - oldCharge + newCharge; }
+
+    bool empty() const { return head.next == &head; }
+    CacheEntry* front() const { return static_cast<CacheEntry*>(head.next); }
+    CacheEntry* back() const { return static_cast<CacheEntry*>(head.prev); }
+    size_t bytes() const { return usage; }
+
+    template <typename Fn>
+    void forEach(Fn fn) const {
+        for (const EntryLink* p = head.next; p != &head; p = p->next) fn(*static_cast<const CacheEntry*>(p));
+    }
+
+private:
+    void link(EntryLink* e) {
+        e->prev = &head;
+        e->next = head.next;
+        head.next->prev = e;
+        head.next = e;
+    }
+    static void unlink(EntryLink* e) {
+        e->prev->next = e->next;
+        e->next->prev = e->prev;
+    }
+
+    EntryLink head;  // 哨兵，head.next为表头，head.prev为表尾
+    size_t usage;    // 队列中条目的总字节
+};
+
+class EvictionPolicy {
+public:
+    virtual ~EvictionPolicy() {}
+
+    // 新条目加入缓存
+    virtual void onInsert(CacheEntry& e) = 0;
+    // 命中
+    virtual void onHit(CacheEntry& e) = 0;
+    // 未命中，用于频率统计
+    virtual void onMiss(int key) { (void)key; }
+    // 覆盖写导致条目大小变化，视为一次访问
+    virtual void onUpdate(CacheEntry& e, size_t oldCharge) = 0;
+    // 条目被删除或淘汰，从策略队列中解除
+    virtual void onErase(CacheEntry& e) = 0;
+    // 选出下一个要淘汰的条目，缓存非空时调用
+    virtual CacheEntry* victim() = 0;
+    // 从热到冷遍历，调试输出用
+    virtual void forEach(const std::function<void(const CacheEntry&)>& fn) const = 0;
+
+    static std::unique_ptr<EvictionPolicy> create(CachePolicy policy, size_t capacityBytes);
+};
+
+// 纯LRU
+class LRUPolicy : public EvictionPolicy {
+public:
+    void onInsert(CacheEntry& e) override { queue.pushFront(&e); }
+    void onHit(CacheEntry& e) override { queue.moveToFront(&e); }
+    void onUpdate(CacheEntry& e, size_t oldCharge) override;
+    void onErase(CacheEntry& e) override { queue.remove(&e); }
+    CacheEntry* victim() override { return queue.back(); }
+    void forEach(const std::function<void(const CacheEntry&)>& fn) const override { queue.forEach(fn); }
+
+private:
+    EntryQueue queue;
+};
+
+// 分段LRU：新条目进入试用段，再次命中才晋升到保护段，
+// 只被访问一次的扫描流量只会冲刷试用段
+class SLRUPolicy : public EvictionPolicy {
+public:
+    explicit SLRUPolicy(size_t capacityBytes);
+
+    void onInsert(CacheEntry& e) override;
+    void onHit(CacheEntry& e) override;
+    void onUpdate(CacheEntry& e, size_t oldCharge) override;
+    void onErase(CacheEntry& e) override;
+    CacheEntry* victim() override;
+    void forEach(const std::function<void(const CacheEntry&)>& fn) const override;
+
+protected:
+    enum Segment : uint8_t {
+        PROBATION = 0,
+        PROTECTED = 1,
+        WINDOW = 2,
+    };
+
+    EntryQueue& queueOf(CacheEntry& e);
+    // 保护段超出预算时把尾部降级回试用段
+    void demoteOverflow();
+
+    EntryQueue probation;
+    EntryQueue protectedQueue;
+    size_t protectedCapacity;  // 保护段字节预算，占主区的80%
+};
+
+// Count-Min频率草图，4位计数器，累计到一定次数后所有计数减半(老化)
+class FrequencySketch {
+public:
+    explicit FrequencySketch(size_t expectedEntries);
+
+    void increment(int key);
+    uint32_t estimate(int key) const;
+
+private:
+    static const int kDepth = 4;
+
+    size_t indexOf(int key, int row) const;
+    void reset();
+
+    std::vector<uint8_t> counters;  // kDepth行，每行width个计数器
+    size_t width;                   // 每行计数器数，2的幂
+    size_t additions;
+    size_t sampleSize;              // 达到该次数后执行老化
+};
+
+// W-TinyLFU：新条目先进入1%的窗口LRU，溢出后进入主区试用段，
+// 淘汰时用频率草图比较新来者和主区的淘汰候选，频率低者被淘汰
+class TinyLFUPolicy : public SLRUPolicy {
+public:
+    explicit TinyLFUPolicy(size_t capacityBytes);
+
+    void onInsert(CacheEntry& e) override;
+    void onHit(CacheEntry& e) override;
+    void onMiss(int key) override { sketch.increment(key); }
+    void onUpdate(CacheEntry& e, size_t oldCharge) override;
+    void onErase(CacheEntry& e) override;
+    CacheEntry* victim() override;
+    void forEach(const std::function<void(const CacheEntry&)>& fn) const override;
+
+private:
+    EntryQueue window;
+    size_t windowCapacity;  // 窗口字节预算
+    FrequencySketch sketch;
+};
+
+#endif // EVICTION_POLICY_H
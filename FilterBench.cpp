@@ -0,0 +1,87 @@
+#include "ObjectStorage.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+
+// Bloom过滤器测试：
+// 1. 单独的过滤器在不同位数下的负查找率(不存在的key被过滤器直接排除的比例)、误判率和每次查询耗时
+// 2. ObjectStorage在过滤器开/关时查找不存在的key和存在的key的耗时(关闭缓存和负查找缓存，只比较元数据路径)
+// 用法: FilterBench [key数量] [查询次数]
+
+static double elapsedNs(std::chrono::steady_clock::time_point start, size_t ops) {
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / ops;
+}
+
+static void filterOnly(size_t keys, size_t lookups) {
+    std::printf("bits/key bytes/key negative_rate false_positive probe_ns\n");
+    for (unsigned bits : {4u, 6u, 8u, 10u, 12u, 16u}) {
+        BloomFilter filter(keys, bits);
+        for (size_t k = 0; k < keys; ++k) filter.add(static_cast<int>(k));
+
+        std::mt19937 rng(5);
+        std::vector<int> absent(lookups);
+        for (size_t i = 0; i < lookups; ++i) absent[i] = -1 - static_cast<int>(rng() % keys);
+        size_t passed = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (int key : absent) passed += filter.mayContain(key);
+        double ns = elapsedNs(start, lookups);
+
+        double fp = static_cast<double>(passed) / lookups;
+        std::printf("%u %.2f %.4f %.4f %.1f\n", bits, static_cast<double>(filter.memoryBytes()) / keys,
+                    1 - fp, fp, ns);
+    }
+}
+
+static void storage(size_t keys, size_t lookups) {
+    std::printf("\nstorage bits/key filter_bytes/key miss_ns hit_ns\n");
+    const std::string path = "filter_bench.dat";
+    for (unsigned bits : {0u, 10u}) {
+        ObjectStorage::destroy(path);
+        ObjectStorage::Options o;
+        o.filterBitsPerKey = bits;
+        o.negativeCacheSlots = 0;
+        o.cacheBytes = 0;
+        o.backgroundCompaction = false;
+        size_t found = 0;
+        {
+            ObjectStorage store(path, o);
+            std::vector<std::pair<int, ValueRef>> batch;
+            for (size_t k = 0; k < keys; ++k) {
+                batch.emplace_back(static_cast<int>(k), ValueRef::copyOf("filtered", 8));
+                if (batch.size() == 4096 || k + 1 == keys) {
+                    store.multiPut(batch);
+                    batch.clear();
+                }
+            }
+
+            std::mt19937 rng(7);
+            std::vector<int> absent(lookups);
+            std::vector<int> present(lookups);
+            for (size_t i = 0; i < lookups; ++i) {
+                absent[i] = -1 - static_cast<int>(rng() % keys);
+                present[i] = static_cast<int>(rng() % keys);
+            }
+            auto start = std::chrono::steady_clock::now();
+            for (int key : absent) found += static_cast<bool>(store.getRef(key));
+            double missNs = elapsedNs(start, lookups);
+            start = std::chrono::steady_clock::now();
+            for (int key : present) found += static_cast<bool>(store.getRef(key));
+            double hitNs = elapsedNs(start, lookups);
+
+            std::printf("%u %.2f %.1f %.1f\n", bits, static_cast<double>(store.filterBytes()) / keys, missNs, hitNs);
+        }
+        ObjectStorage::destroy(path);
+        if (found != lookups) std::printf("unexpected results: %zu\n", found);
+    }
+}
+
+int main(int argc, char* argv[]) {
+    size_t keys = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+    size_t lookups = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 2000000;
+
+    filterOnly(keys, lookups);
+    storage(keys, lookups);
+    return 0;
+}
@@ -0,0 +1,354 @@
+#ifndef FLAT_HASH_MAP_H
+#define FLAT_HASH_MAP_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <sys/mman.h>
+#include <type_traits>
+#include <utility>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+// 64位混合函数(splitmix64终结器)，表内定位用；分片选择仍用hashKey的低位，两者互不相关
+struct FlatHash {
+    uint64_t operator()(int key) const {
+        uint64_t h = static_cast<uint32_t>(key);
+        h += 0x9e3779b97f4a7c15ull;
+        h = (h ^ (h >> 30)) * 0xbf58476d1ce4e5b9ull;
+        h = (h ^ (h >> 27)) * 0x94d049bb133111ebull;
+        return h ^ (h >> 31);
+    }
+};
+
+// 开放寻址哈希表(Swiss table结构)：键值对连续存放在槽数组中，没有节点和指针
+// 每个槽对应一个控制字节：最高位为1表示空或已删除，否则低7位是哈希值的H2部分；
+// 查找时用SSE2一次比较16个控制字节，只有H2相同的槽才比较键，一次探测通常只访问一条缓存行
+// 负载因子上限7/8；插入会移动已有元素，迭代器和指针在插入后失效
+// 只支持可平凡复制的键和值
+template <typename K, typename V, typename Hash = FlatHash>
+class FlatHashMap {
+    static_assert(std::is_trivially_copyable<K>::value && std::is_trivially_copyable<V>::value,
+                  "FlatHashMap只支持可平凡复制的键和值");
+
+public:
+    struct value_type {
+        K first;
+        V second;
+    };
+
+    template <bool Const>
+    class Iter {
+    public:
+        using Ref = typename std::conditional<Const, const value_type&, value_type&>::type;
+        using Ptr = typename std::conditional<Const, const value_type*, value_type*>::type;
+
+        Iter() : ctrl(nullptr), slot(nullptr), last(nullptr) {}
+        Iter(const int8_t* ctrl, Ptr slot, const int8_t* last) : ctrl(ctrl), slot(slot), last(last) { skip(); }
+        template <bool C, typename = typename std::enable_if<Const && !C>::type>
+        Iter(const Iter<C>& other) : ctrl(other.ctrl), slot(other.slot), last(other.last) {}
+
+        Ref operator*() const { return *slot; }
+        Ptr operator->() const { return slot; }
+        Iter& operator++() {
+            ++ctrl;
+            ++slot;
+            skip();
+            return *this;
+        }
+        bool operator==(const Iter& other) const { return ctrl == other.ctrl; }
+        bool operator!=(const Iter& other) const { return ctrl != other.ctrl; }
+
+    private:
+        friend class FlatHashMap;
+        template <bool>
+        friend class Iter;
+
+        // 跳过空槽和已删除的槽，直到下一个有效元素或末尾
+        void skip() {
+            while (ctrl != last && *ctrl < 0) {
+                ++ctrl;
+                ++slot;
+            }
+        }
+
+        const int8_t* ctrl;
+        Ptr slot;
+        const int8_t* last;
+    };
+
+    using iterator = Iter<false>;
+    using const_iterator = Iter<true>;
+
+    FlatHashMap() : ctrl(emptyGroup()), slots(nullptr), mask(0), count(0), deleted(0), growthLeft(0) {}
+
+    ~FlatHashMap() { release(); }
+
+    FlatHashMap(const FlatHashMap&) = delete;
+    FlatHashMap& operator=(const FlatHashMap&) = delete;
+
+    FlatHashMap(FlatHashMap&& other) : FlatHashMap() { swap(other); }
+    FlatHashMap& operator=(FlatHashMap&& other) {
+        if (this != &other) {
+            release();
+            reset();
+            swap(other);
+        }
+        return *this;
+    }
+
+    iterator begin() { return iterator(ctrl, slots, ctrl + capacity()); }
+    iterator end() { return iterator(ctrl + capacity(), slots + capacity(), ctrl + capacity()); }
+    const_iterator begin() const { return const_iterator(ctrl, slots, ctrl + capacity()); }
+    const_iterator end() const { return const_iterator(ctrl + capacity(), slots + capacity(), ctrl + capacity()); }
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    size_t capacity() const { return mask == 0 ? 0 : mask + 1; }
+
+    // 控制字节和槽数组占用的字节
+    size_t memoryBytes() const {
+        return capacity() == 0 ? 0 : capacity() * sizeof(value_type) + capacity() + kGroup;
+    }
+
+    iterator find(const K& key) {
+        size_t i = findIndex(key);
+        return i == kNotFound ? end() : iteratorAt(i);
+    }
+
+    const_iterator find(const K& key) const {
+        size_t i = findIndex(key);
+        return i == kNotFound ? end() : const_iterator(ctrl + i, slots + i, ctrl + capacity());
+    }
+
+    // 键已存在时不修改，返回已有元素
+    std::pair<iterator, bool> emplace(const K& key, const V& value) {
+        uint64_t h = Hash()(key);
+        size_t i = findIndex(key, h);
+        if (i != kNotFound) return std::make_pair(iteratorAt(i), false);
+        i = insertIndex(h);
+        slots[i].first = key;
+        slots[i].second = value;
+        return std::make_pair(iteratorAt(i), true);
+    }
+
+    // 不存在时插入值初始化的元素
+    V& operator[](const K& key) {
+        uint64_t h = Hash()(key);
+        size_t i = findIndex(key, h);
+        if (i == kNotFound) {
+            i = insertIndex(h);
+            slots[i].first = key;
+            slots[i].second = V();
+        }
+        return slots[i].second;
+    }
+
+    size_t erase(const K& key) {
+        size_t i = findIndex(key);
+        if (i == kNotFound) return 0;
+        eraseAt(i);
+        return 1;
+    }
+
+    void erase(iterator it) { eraseAt(static_cast<size_t>(it.ctrl - ctrl)); }
+
+    void clear() {
+        release();
+        reset();
+    }
+
+    // 预留至少n个元素的空间，之后插入不再扩容
+    void reserve(size_t n) {
+        size_t cap = kGroup;
+        while (cap - cap / 8 < n) cap *= 2;
+        if (cap > capacity()) rehash(cap);
+    }
+
+    void swap(FlatHashMap& other) {
+        std::swap(ctrl, other.ctrl);
+        std::swap(slots, other.slots);
+        std::swap(mask, other.mask);
+        std::swap(count, other.count);
+        std::swap(deleted, other.deleted);
+        std::swap(growthLeft, other.growthLeft);
+    }
+
+private:
+    static const size_t kGroup = 16;
+    static const size_t kNotFound = static_cast<size_t>(-1);
+    static const int8_t kEmpty = -128;    // 0b10000000
+    static const int8_t kDeleted = -2;    // 0b11111110
+
+    // 容量为0时的控制字节，全部为空，查找不需要特殊处理
+    static int8_t* emptyGroup() {
+        alignas(16) static int8_t group[kGroup] = {
+            kEmpty, kEmpty, kEmpty, kEmpty, kEmpty, kEmpty, kEmpty, kEmpty,
+            kEmpty, kEmpty, kEmpty, kEmpty, kEmpty, kEmpty, kEmpty, kEmpty,
+        };
+        return group;
+    }
+
+    static size_t h1(uint64_t h) { return static_cast<size_t>(h >> 7); }
+    static int8_t h2(uint64_t h) { return static_cast<int8_t>(h & 0x7f); }
+
+    // 一组16个控制字节中等于b的位置的位图
+    static uint32_t match(const int8_t* group, int8_t b) {
+#ifdef __SSE2__
+        __m128i g = _mm_loadu_si128(reinterpret_cast<const __m128i*>(group));
+        return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(g, _mm_set1_epi8(b))));
+#else
+        uint32_t bits = 0;
+        for (size_t i = 0; i < kGroup; ++i) bits |= static_cast<uint32_t>(group[i] == b) << i;
+        return bits;
+#endif
+    }
+
+    // 空槽或已删除槽的位图(最高位为1)
+    static uint32_t matchEmptyOrDeleted(const int8_t* group) {
+#ifdef __SSE2__
+        __m128i g = _mm_loadu_si128(reinterpret_cast<const __m128i*>(group));
+        return static_cast<uint32_t>(_mm_movemask_epi8(g));
+#else
+        uint32_t bits = 0;
+        for (size_t i = 0; i < kGroup; ++i) bits |= static_cast<uint32_t>(group[i] < 0) << i;
+        return bits;
+#endif
+    }
+
+    static size_t lowestBit(uint32_t bits) { return static_cast<size_t>(__builtin_ctz(bits)); }
+
+    iterator iteratorAt(size_t i) {
+        iterator it;
+        it.ctrl = ctrl + i;
+        it.slot = slots + i;
+        it.last = ctrl + capacity();
+        return it;
+    }
+
+    size_t findIndex(const K& key) const { return findIndex(key, Hash()(key)); }
+
+    // 按组做三角探测：第n次探测跳过n个组，容量为2的幂时能遍历所有组
+    size_t findIndex(const K& key, uint64_t h) const {
+        size_t pos = h1(h) & mask;
+        int8_t tag = h2(h);
+        for (size_t step = kGroup;; step += kGroup) {
+            const int8_t* group = ctrl + pos;
+            for (uint32_t bits = match(group, tag); bits != 0; bits &= bits - 1) {
+                size_t i = (pos + lowestBit(bits)) & mask;
+                if (slots[i].first == key) return i;
+            }
+            // 组内有空槽说明键不存在(已删除的槽不中断探测)
+            if (match(group, kEmpty) != 0) return kNotFound;
+            pos = (pos + step) & mask;
+        }
+    }
+
+    // 为哈希值h找一个空槽或已删除槽并设置控制字节，必要时先扩容
+    size_t insertIndex(uint64_t h) {
+        if (growthLeft == 0) {
+            // 删除留下的槽过多时原地重建，否则翻倍
+            size_t cap = capacity();
+            rehash(cap == 0 ? kGroup : (deleted >= cap / 16 ? cap : cap * 2));
+        }
+        size_t pos = h1(h) & mask;
+        for (size_t step = kGroup;; step += kGroup) {
+            uint32_t bits = matchEmptyOrDeleted(ctrl + pos);
+            if (bits != 0) {
+                size_t i = (pos + lowestBit(bits)) & mask;
+                if (ctrl[i] == kDeleted) {
+                    --deleted;
+                } else {
+                    --growthLeft;
+                }
+                setCtrl(i, h2(h));
+                ++count;
+                return i;
+            }
+            pos = (pos + step) & mask;
+        }
+    }
+
+    void eraseAt(size_t i) {
+        setCtrl(i, kDeleted);
+        --count;
+        ++deleted;
+    }
+
+    // 控制字节数组末尾复制了开头的kGroup个字节，跨越末尾的组也能一次读取
+    void setCtrl(size_t i, int8_t b) {
+        ctrl[i] = b;
+        if (i < kGroup) ctrl[capacity() + i] = b;
+    }
+
+    void rehash(size_t newCapacity) {
+        int8_t* oldCtrl = ctrl;
+        value_type* oldSlots = slots;
+        size_t oldCapacity = capacity();
+
+        void* c = allocate(newCapacity + kGroup);
+        void* s = nullptr;
+        try {
+            s = allocate(newCapacity * sizeof(value_type));
+        } catch (...) {
+            std::free(c);
+            throw;
+        }
+        ctrl = static_cast<int8_t*>(c);
+        slots = static_cast<value_type*>(s);
+        std::memset(ctrl, kEmpty, newCapacity + kGroup);
+        mask = newCapacity - 1;
+        growthLeft = newCapacity - newCapacity / 8;
+        count = 0;
+        deleted = 0;
+
+        for (size_t i = 0; i < oldCapacity; ++i) {
+            if (oldCtrl[i] < 0) continue;
+            size_t j = insertIndex(Hash()(oldSlots[i].first));
+            std::memcpy(static_cast<void*>(&slots[j]), &oldSlots[i], sizeof(value_type));
+        }
+        if (oldCapacity != 0) {
+            std::free(oldCtrl);
+            std::free(oldSlots);
+        }
+    }
+
+    // 大表按2MB对齐并建议使用透明大页，随机查找时减少TLB未命中
+    static void* allocate(size_t bytes) {
+        const size_t kHugePage = 2 << 20;
+        size_t align = bytes >= kHugePage ? kHugePage : kGroup;
+        void* p = nullptr;
+        if (posix_memalign(&p, align, bytes) != 0) throw std::bad_alloc();
+        if (align == kHugePage) madvise(p, bytes, MADV_HUGEPAGE);
+        return p;
+    }
+
+    void release() {
+        if (capacity() != 0) {
+            std::free(ctrl);
+            std::free(slots);
+        }
+    }
+
+    void reset() {
+        ctrl = emptyGroup();
+        slots = nullptr;
+        mask = 0;
+        count = 0;
+        deleted = 0;
+        growthLeft = 0;
+    }
+
+    int8_t* ctrl;          // capacity + kGroup个控制字节
+    value_type* slots;
+    size_t mask;           // capacity - 1，容量为0时为0
+    size_t count;
+    size_t deleted;        // 已删除的槽，查找时不中断探测
+    size_t growthLeft;     // 还能使用的空槽数，用完时扩容或重建
+};
+
+#endif // FLAT_HASH_MAP_H
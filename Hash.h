@@ -0,0 +1,80 @@
+#ifndef HASH_H
+#define HASH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+// murmur3 finalizer，打散连续的key，用于选择分片
+inline uint32_t hashKey(int key) {
+    uint32_t h = static_cast<uint32_t>(key);
+    h ^= h >> 16;
+    h *= 0x85ebca6b;
+    h ^= h >> 13;
+    h *= 0xc2b2ae35;
+    h ^= h >> 16;
+    return h;
+}
+
+// 64x64->128位乘法后高低位异或(wyhash的mum)，定长和变长key的哈希都用它混合
+inline uint64_t mix128(uint64_t a, uint64_t b) {
+    __uint128_t r = static_cast<__uint128_t>(a) * b;
+    return static_cast<uint64_t>(r) ^ static_cast<uint64_t>(r >> 64);
+}
+
+inline uint64_t load64(const char* p) {
+    uint64_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+inline uint64_t load32(const char* p) {
+    uint32_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+// 按wyhash的结构对任意字节做哈希：不超过16字节的key只做两次乘法，更长的每16字节混合一次
+inline uint64_t hashBytes(const char* p, size_t len) {
+    const uint64_t k0 = 0xa0761d6478bd642full;
+    const uint64_t k1 = 0xe7037ed1a0b428dbull;
+    uint64_t seed = mix128(k0, k1);
+    uint64_t a = 0;
+    uint64_t b = 0;
+    if (len <= 16) {
+        if (len >= 4) {
+            size_t step = (len >> 3) << 2;
+            a = (load32(p) << 32) | load32(p + step);
+            b = (load32(p + len - 4) << 32) | load32(p + len - 4 - step);
+        } else if (len > 0) {
+            a = (static_cast<uint64_t>(static_cast<uint8_t>(p[0])) << 16)
+                | (static_cast<uint64_t>(static_cast<uint8_t>(p[len >> 1])) << 8)
+                | static_cast<uint8_t>(p[len - 1]);
+        }
+    } else {
+        size_t i = len;
+        while (i > 16) {
+            seed = mix128(load64(p) ^ k1, load64(p + 8) ^ seed);
+            p += 16;
+            i -= 16;
+        }
+        // 最后16字节可能与上一轮重叠，len>16保证不会越过开头
+        a = load64(p + i - 16);
+        b = load64(p + i - 8);
+    }
+    __uint128_t r = static_cast<__uint128_t>(a ^ k1) * (b ^ seed);
+    return mix128(static_cast<uint64_t>(r) ^ k0 ^ len, static_cast<uint64_t>(r >> 64) ^ k1);
+}
+
+// 按分片对下标做计数排序：shardOf[i]为第i个元素所在的分片(小于shardCount)
+// order中的下标按分片排列，同一分片内保持原来的顺序；批量接口据此每个分片只加一次锁
+inline void orderByShard(const std::vector<uint32_t>& shardOf, size_t shardCount, std::vector<uint32_t>& order) {
+    std::vector<uint32_t> start(shardCount + 1, 0);
+    for (uint32_t s : shardOf) ++start[s + 1];
+    for (size_t s = 0; s < shardCount; ++s) start[s + 1] += start[s];
+    order.resize(shardOf.size());
+    for (uint32_t i = 0; i < shardOf.size(); ++i) order[start[shardOf[i]]++] = i;
+}
+
+#endif // HASH_H
@@ -0,0 +1,113 @@
+#include "FlatHashMap.h"
+#include "PackedIndex.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <malloc.h>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+// 元数据索引测试：比较std::unordered_map、FlatHashMap存放20字节的元数据条目和PackedIndex
+// 存放8字节紧凑位置时每个key的内存占用，以及命中和未命中查找的平均耗时
+// 用法: IndexBench [key数量] [查找次数] [只测试的表名]
+// 例如 IndexBench 100000000 5000000 packed 只测packed，避免大表同时占用内存
+
+#pragma pack(push, 4)
+struct Entry {
+    int key;
+    uint32_t segment;
+    uint64_t offset;
+    uint32_t size;
+};
+#pragma pack(pop)
+
+static size_t heapBytes() {
+    struct mallinfo2 info = mallinfo2();
+    return info.uordblks + info.hblkhd;   // 大块由mmap分配，单独统计
+}
+
+// 与ObjectStorage相同的配置：64MB的段需要27位偏移
+struct Packed {
+    PackedIndex<int> index{27};
+    void emplace(int key, const Entry& e) { index.assign(key, Location{e.segment, e.offset, e.size}); }
+};
+
+template <typename Map>
+static bool lookup(const Map& map, int key, uint64_t& offset) {
+    auto it = map.find(key);
+    if (it == map.end()) return false;
+    offset = it->second.offset;
+    return true;
+}
+
+static bool lookup(const Packed& map, int key, uint64_t& offset) {
+    Location loc;
+    if (!map.index.find(key, loc)) return false;
+    offset = loc.offset;
+    return true;
+}
+
+template <typename Map>
+static void run(const char* name, const std::vector<int>& keys, size_t lookups) {
+    size_t before = heapBytes();
+    Map* map = new Map();
+    auto start = std::chrono::steady_clock::now();
+    for (int key : keys) {
+        // 相当于按key顺序写入64字节的记录，每64MB切换一个段
+        uint64_t pos = static_cast<uint64_t>(key) * 64;
+        Entry e = {key, static_cast<uint32_t>(pos >> 26) + 1, pos & ((1u << 26) - 1), 100};
+        map->emplace(key, e);
+    }
+    double insertNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / keys.size();
+    double bytesPerKey = static_cast<double>(heapBytes() - before) / keys.size();
+
+    std::mt19937 rng(11);
+    std::uniform_int_distribution<size_t> pick(0, keys.size() - 1);
+    std::vector<int> hits(lookups);
+    std::vector<int> misses(lookups);
+    for (size_t i = 0; i < lookups; ++i) {
+        hits[i] = keys[pick(rng)];
+        misses[i] = -1 - static_cast<int>(pick(rng));   // 负数key不在表中
+    }
+
+    uint64_t checksum = 0;
+    start = std::chrono::steady_clock::now();
+    for (int key : hits) {
+        uint64_t offset = 0;
+        if (lookup(*map, key, offset)) checksum += offset;
+    }
+    double hitNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / lookups;
+
+    start = std::chrono::steady_clock::now();
+    for (int key : misses) {
+        uint64_t offset = 0;
+        checksum += lookup(*map, key, offset);
+    }
+    double missNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / lookups;
+
+    std::printf("%s %zu %.1f %.1f %.1f %.1f%s\n", name, keys.size(), bytesPerKey, insertNs, hitNs, missNs,
+                checksum == 0 ? " (empty)" : "");
+    delete map;
+}
+
+int main(int argc, char* argv[]) {
+    size_t count = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 10000000;
+    size_t lookups = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 5000000;
+    const char* only = argc > 3 ? argv[3] : nullptr;
+    auto selected = [only](const char* name) { return !only || std::strcmp(only, name) == 0; };
+
+    std::printf("map keys bytes/key insert_ns hit_ns miss_ns\n");
+    for (size_t n : {count / 100, count}) {
+        std::vector<int> keys(n);
+        for (size_t i = 0; i < n; ++i) keys[i] = static_cast<int>(i);
+        std::shuffle(keys.begin(), keys.end(), std::mt19937(3));
+        if (selected("unordered_map")) run<std::unordered_map<int, Entry>>("unordered_map", keys, lookups);
+        if (selected("flat")) run<FlatHashMap<int, Entry>>("flat", keys, lookups);
+        if (selected("packed")) run<Packed>("packed", keys, lookups);
+    }
+    return 0;
+}
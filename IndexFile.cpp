@@ -0,0 +1,133 @@
+#include "IndexFile.h"
+
+#include <cstdio>
+
+const char IndexFile::kMagic[8] = {'O', 'S', 'I', 'N', 'D', 'E', 'X', '1'};
+
+IndexFile::IndexFile(const std::string& path)
+    : path(path), fd(-1), records(0), coveredSegment(0), coveredEnd(0), headerSegment(0), headerEnd(0) {
+    openFile();
+}
+
+IndexFile::~IndexFile() {
+    if (fd >= 0) {
+        close(fd);
+    }
+}
+
+void IndexFile::openFile() {
+    fd = open(path.c_str(), O_RDWR | O_CREAT | O_APPEND, 0644);
+    if (fd < 0) {
+        throw std::runtime_error("无法打开索引文件: " + path);
+    }
+}
+
+void IndexFile::reset() {
+    if (ftruncate(fd, 0) != 0) {
+        throw std::runtime_error("无法截断索引文件: " + path);
+    }
+    writeHeader(fd, 0, 0);
+    records = 0;
+    coveredSegment = headerSegment = 0;
+    coveredEnd = headerEnd = 0;
+}
+
+void IndexFile::cover(uint32_t segment, uint64_t end) {
+    if (segment > coveredSegment) {
+        coveredSegment = segment;
+        coveredEnd = end;
+    } else if (segment == coveredSegment && end > coveredEnd) {
+        coveredEnd = end;
+    }
+}
+
+void IndexFile::writeHeader(int targetFd, uint32_t dataSegment, uint64_t dataEnd) {
+    Header header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.dataSegment = dataSegment;
+    header.dataEnd = dataEnd;
+    if (write(targetFd, &header, sizeof(header)) != static_cast<ssize_t>(sizeof(header))) {
+        throw std::runtime_error("写入索引文件头失败");
+    }
+}
+
+void IndexFile::append(uint8_t op, int key, uint32_t segment, uint64_t offset, uint32_t size) {
+    Record rec;
+    std::memset(&rec, 0, sizeof(rec));
+    rec.op = op;
+    rec.key = key;
+    rec.size = size;
+    rec.segment = segment;
+    rec.offset = offset;
+    rec.crc = checksum(rec);
+    if (write(fd, &rec, sizeof(rec)) != static_cast<ssize_t>(sizeof(rec))) {
+        throw std::runtime_error("写入索引记录失败: " + path);
+    }
+    ++records;
+    cover(segment, offset + size);
+}
+
+void IndexFile::append(std::vector<Record>& batch) {
+    if (batch.empty()) return;
+    for (Record& rec : batch) {
+        rec.crc = checksum(rec);
+        cover(rec.segment, rec.offset + rec.size);
+    }
+    size_t bytes = batch.size() * sizeof(Record);
+    if (write(fd, batch.data(), bytes) != static_cast<ssize_t>(bytes)) {
+        throw std::runtime_error("写入索引记录失败: " + path);
+    }
+    records += batch.size();
+}
+
+void IndexFile::sync() {
+    fdatasync(fd);
+}
+
+void IndexFile::writeFile(const std::string& target, const std::vector<Record>& live,
+                          uint32_t dataSegment, uint64_t dataEnd) {
+    int tmpFd = open(target.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (tmpFd < 0) {
+        throw std::runtime_error("无法创建索引文件: " + target);
+    }
+    writeHeader(tmpFd, dataSegment, dataEnd);
+
+    // 分批写出，避免逐条系统调用
+    std::vector<Record> batch;
+    batch.reserve(4096);
+    for (size_t i = 0; i < live.size(); ++i) {
+        Record rec = live[i];
+        rec.crc = checksum(rec);
+        batch.push_back(rec);
+        if (batch.size() == 4096 || i + 1 == live.size()) {
+            size_t bytes = batch.size() * sizeof(Record);
+            if (write(tmpFd, batch.data(), bytes) != static_cast<ssize_t>(bytes)) {
+                close(tmpFd);
+                throw std::runtime_error("写入索引文件失败: " + target);
+            }
+            batch.clear();
+        }
+    }
+    fsync(tmpFd);
+    close(tmpFd);
+}
+
+void IndexFile::rewrite(const std::vector<Record>& live, uint32_t dataSegment, uint64_t dataEnd) {
+    std::string tmpPath = path + ".tmp";
+    writeFile(tmpPath, live, dataSegment, dataEnd);
+
+    if (std::rename(tmpPath.c_str(), path.c_str()) != 0) {
+        throw std::runtime_error("替换索引文件失败: " + path);
+    }
+    reopen(live.size(), dataSegment, dataEnd);
+}
+
+void IndexFile::reopen(size_t recordCount, uint32_t dataSegment, uint64_t dataEnd) {
+    close(fd);
+    openFile();
+    records = recordCount;
+    coveredSegment = headerSegment = dataSegment;
+    coveredEnd = headerEnd = dataEnd;
+}
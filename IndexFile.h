@@ -0,0 +1,162 @@
+#ifndef INDEX_FILE_H
+#define INDEX_FILE_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "Crc32c.h"
+
+// 持久化索引文件：定长记录追加写，打开时mmap回放
+// 文件布局: [Header][Record][Record]...
+class IndexFile {
+public:
+    enum Op : uint8_t {
+        OP_PUT = 1,
+        OP_DEL = 2,
+    };
+
+    struct Header {
+        char magic[8];       // "OSINDEX1"
+        uint32_t version;    // 格式版本
+        uint32_t dataSegment;  // 重写索引时已覆盖到的段
+        uint64_t dataEnd;      // 该段中已覆盖到的位置
+    };
+
+    struct Record {
+        uint32_t crc;        // 其余字段的CRC32C
+        uint8_t op;          // OP_PUT / OP_DEL
+        uint8_t reserved[3];
+        int32_t key;         // 对象Key
+        uint32_t size;       // 对象大小
+        uint32_t segment;    // 所在日志段
+        uint32_t reserved2;
+        uint64_t offset;     // 段内偏移量(value起始位置)
+    };
+
+    static_assert(sizeof(Record) == 32, "Record must be 32 bytes");
+
+    explicit IndexFile(const std::string& path);
+    ~IndexFile();
+
+    // 回放全部有效记录，遇到校验失败的记录即视为残缺尾部并截断
+    // apply(record, 记录在文件中的序号)；重写后的前若干条记录就是重写时的存活快照
+    // segmentSize(id)返回日志段当前大小(段不存在时为0)，指向段外的记录已被压缩搬走，跳过
+    // 格式不匹配的旧索引会被清空，由调用方从数据文件重建
+    template <typename SegmentSize, typename Apply>
+    size_t load(SegmentSize segmentSize, Apply apply);
+
+    // 追加一条记录，offset+size 为该记录在所在段中的结束位置
+    void append(uint8_t op, int key, uint32_t segment, uint64_t offset, uint32_t size);
+
+    // 批量追加，计算校验和后一次写入
+    void append(std::vector<Record>& batch);
+
+    // 把已追加的记录刷到磁盘
+    void sync();
+
+    // 用存活记录重写索引，写临时文件后rename保证原子性
+    void rewrite(const std::vector<Record>& live, uint32_t dataSegment, uint64_t dataEnd);
+
+    // 把存活记录写成一个完整的索引文件(已fsync)，由调用方负责切换
+    static void writeFile(const std::string& target, const std::vector<Record>& live,
+                          uint32_t dataSegment, uint64_t dataEnd);
+
+    // 索引文件被外部替换(writeFile + rename)后重新打开
+    void reopen(size_t recordCount, uint32_t dataSegment, uint64_t dataEnd);
+
+    size_t recordCount() const { return records; }
+
+    // 索引已覆盖到的位置(段, 段内偏移)，之后的数据需要扫描日志补齐
+    uint32_t dataSegment() const { return coveredSegment; }
+    uint64_t dataEnd() const { return coveredEnd; }
+
+    // 文件头记录的位置，即最近一次重写时的日志末尾，用于识别与该快照一起保存的其他文件
+    uint32_t snapshotSegment() const { return headerSegment; }
+    uint64_t snapshotEnd() const { return headerEnd; }
+
+    static uint32_t checksum(const Record& rec) {
+        return crc32c::value(reinterpret_cast<const char*>(&rec) + sizeof(rec.crc),
+                             sizeof(Record) - sizeof(rec.crc));
+    }
+
+private:
+    static const char kMagic[8];
+    static const uint32_t kVersion = 3;
+
+    void openFile();
+    void reset();
+    static void writeHeader(int targetFd, uint32_t dataSegment, uint64_t dataEnd);
+    // 覆盖范围按(段, 偏移)取最大值
+    void cover(uint32_t segment, uint64_t end);
+
+    std::string path;
+    int fd;
+    size_t records;       // 文件中的记录数(包括已失效的)
+    uint32_t coveredSegment;
+    uint64_t coveredEnd;
+    uint32_t headerSegment;
+    uint64_t headerEnd;
+};
+
+template <typename SegmentSize, typename Apply>
+size_t IndexFile::load(SegmentSize segmentSize, Apply apply) {
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        throw std::runtime_error("无法读取索引文件状态: " + path);
+    }
+    size_t fileSize = static_cast<size_t>(st.st_size);
+    if (fileSize < sizeof(Header)) {
+        // 空文件或头部残缺，重新初始化
+        reset();
+        return 0;
+    }
+
+    void* addr = mmap(nullptr, fileSize, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (addr == MAP_FAILED) {
+        throw std::runtime_error("无法映射索引文件: " + path);
+    }
+    madvise(addr, fileSize, MADV_SEQUENTIAL);
+
+    const char* base = static_cast<const char*>(addr);
+    Header header;
+    std::memcpy(&header, base, sizeof(header));
+    // 覆盖到的段已被压缩删除时大小为0，不算不一致
+    uint64_t coveredLimit = segmentSize(header.dataSegment);
+    if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 || header.version != kVersion
+        || (coveredLimit != 0 && header.dataEnd > coveredLimit)) {
+        munmap(addr, fileSize);
+        reset();
+        return 0;
+    }
+    coveredSegment = headerSegment = header.dataSegment;
+    coveredEnd = headerEnd = header.dataEnd;
+
+    size_t count = (fileSize - sizeof(Header)) / sizeof(Record);
+    size_t valid = 0;
+    const char* p = base + sizeof(Header);
+    for (; valid < count; ++valid, p += sizeof(Record)) {
+        Record rec;
+        std::memcpy(&rec, p, sizeof(rec));
+        if (rec.crc != checksum(rec)) break;
+        if (rec.offset + rec.size > segmentSize(rec.segment)) continue;
+        apply(rec, valid);
+        cover(rec.segment, rec.offset + rec.size);
+    }
+    munmap(addr, fileSize);
+
+    size_t validSize = sizeof(Header) + valid * sizeof(Record);
+    if (validSize != fileSize && ftruncate(fd, validSize) != 0) {
+        throw std::runtime_error("无法截断索引文件: " + path);
+    }
+    records = valid;
+    return valid;
+}
+
+#endif // INDEX_FILE_H
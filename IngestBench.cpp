@@ -0,0 +1,66 @@
+#include "ObjectStorage.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+
+// 写入吞吐测试：多线程put小对象，比较三种刷盘策略下的ops/s和组提交的平均批大小
+// 用法: IngestBench [最大线程数] [每线程操作数] [对象大小] [刷盘间隔ms]
+
+static const char* policyName(ObjectStorage::SyncPolicy policy) {
+    switch (policy) {
+    case ObjectStorage::SyncPolicy::None: return "none";
+    case ObjectStorage::SyncPolicy::Interval: return "interval";
+    case ObjectStorage::SyncPolicy::EveryBatch: return "every_batch";
+    }
+    return "unknown";
+}
+
+int main(int argc, char* argv[]) {
+    size_t maxThreads = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 16;
+    size_t ops = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 20000;
+    size_t valueSize = argc > 3 ? std::strtoull(argv[3], nullptr, 10) : 100;
+    uint32_t intervalMs = argc > 4 ? static_cast<uint32_t>(std::strtoul(argv[4], nullptr, 10)) : 10;
+    if (maxThreads == 0) maxThreads = 1;
+    const std::string path = "ingest_bench.dat";
+
+    std::cout << "policy threads ops/s avg_batch syncs" << std::endl;
+    for (auto policy : {ObjectStorage::SyncPolicy::None, ObjectStorage::SyncPolicy::Interval,
+                        ObjectStorage::SyncPolicy::EveryBatch}) {
+        for (size_t threads = 1; threads <= maxThreads; threads *= 4) {
+            ObjectStorage::destroy(path);
+            ObjectStorage::Options options;
+            options.cacheBytes = 1 << 20;
+            options.backgroundCompaction = false;
+            options.syncPolicy = policy;
+            options.syncIntervalMs = intervalMs;
+            ObjectStorage storage(path, options);
+
+            std::atomic<bool> go(false);
+            std::vector<std::thread> writers;
+            for (size_t t = 0; t < threads; ++t) {
+                writers.emplace_back([&, t]() {
+                    std::vector<char> value(valueSize, 'x');
+                    while (!go.load()) {}
+                    for (size_t i = 0; i < ops; ++i) {
+                        storage.put(static_cast<int>(t * ops + i), value);
+                    }
+                });
+            }
+            auto start = std::chrono::steady_clock::now();
+            go.store(true);
+            for (auto& w : writers) w.join();
+            double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+            ObjectStorage::WriteStats stats = storage.writeStats();
+            double avgBatch = stats.batches ? static_cast<double>(stats.records) / stats.batches : 0;
+            std::cout << policyName(policy) << " " << threads << " " << threads * ops / sec << " "
+                      << avgBatch << " " << stats.syncs << std::endl;
+        }
+    }
+
+    ObjectStorage::destroy(path);
+    return 0;
+}
@@ -0,0 +1,182 @@
+#include "KVStore.h"
+
+#include <fcntl.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <climits>
+#include <iostream>
+#include <stdexcept>
+
+#include "DataLog.h"
+
+template <typename Key>
+BasicKVStore<Key>::BasicKVStore(size_t buffer_limit, const std::string& disk_filename)
+    : HashMap(kOffsetBits), bufferLimit(buffer_limit), diskFd(-1), diskEnd(0), disk_filename(disk_filename) {
+    diskFd = open(disk_filename.c_str(), O_RDWR | O_CREAT, 0644);
+    if (diskFd < 0) {
+        throw std::runtime_error("无法打开磁盘文件");
+    }
+    recover();
+}
+
+template <typename Key>
+BasicKVStore<Key>::~BasicKVStore() {
+    if (diskFd >= 0) {
+        try {
+            flushBuffersToDisk();
+        } catch (const std::exception& e) {
+            std::cerr << "KVStore flush failed: " << e.what() << std::endl;
+        }
+        close(diskFd);
+    }
+}
+
+template <typename Key>
+void BasicKVStore<Key>::recover() {
+    datalog::LogScanner scanner(disk_filename);
+    Key key;
+    diskEnd = scanner.scan(0, [this, &key](const datalog::RecordHeader& header, uint64_t offset, const char* data) {
+        if (!Traits::decode(header.key, data, header.length, key)) return;
+        uint32_t keyLength = Traits::encodedSize(key);
+        if (header.flags == datalog::FLAG_PUT) {
+            assign(key, Location{kOnDisk, offset + keyLength, header.length - keyLength});
+        } else {
+            HashMap.erase(Traits::view(key));
+        }
+    });
+    // 截掉写了一半的残缺记录
+    if (ftruncate(diskFd, diskEnd) != 0) {
+        throw std::runtime_error("无法截断磁盘文件");
+    }
+}
+
+template <typename Key>
+void BasicKVStore<Key>::assign(const Key& key, const Location& loc) {
+    Stored stored = Traits::view(key);
+    if (Traits::kInterned && !HashMap.contains(stored)) stored = Traits::intern(key, keyArena);
+    HashMap.assign(stored, loc);
+}
+
+template <typename Key>
+bool BasicKVStore<Key>::write(const Key& key, const std::vector<char>& value) {
+    std::lock_guard<std::mutex> lock(mutex);
+    writeBuffer.push_back(BufferedWrite{key, datalog::FLAG_PUT, value});
+    assign(key, Location{kBuffered, writeBuffer.size() - 1, static_cast<uint32_t>(value.size())});
+
+    if (writeBuffer.size() >= bufferLimit) {
+        flushLocked();
+    }
+    return true;
+}
+
+template <typename Key>
+void BasicKVStore<Key>::flushBuffersToDisk() {
+    std::lock_guard<std::mutex> lock(mutex);
+    flushLocked();
+}
+
+template <typename Key>
+void BasicKVStore<Key>::flushLocked() {
+    if (writeBuffer.empty()) return;
+
+    // 整个缓冲区组成一组iovec，用尽量少的pwritev写出
+    std::vector<datalog::RecordHeader> headers(writeBuffer.size());
+    std::vector<uint64_t> offsets(writeBuffer.size());
+    std::vector<struct iovec> iov;
+    iov.reserve(writeBuffer.size() * 3);
+    uint64_t pos = diskEnd;
+    for (size_t i = 0; i < writeBuffer.size(); ++i) {
+        const BufferedWrite& w = writeBuffer[i];
+        uint32_t length = static_cast<uint32_t>(w.value.size());
+        uint32_t keyLength = Traits::encodedSize(w.key);
+        const char* keyBytes = Traits::encodedData(w.key);
+        headers[i] = datalog::makeHeader(w.flags, Traits::headerKey(w.key), keyBytes, keyLength, w.value.data(), length);
+        iov.push_back({&headers[i], sizeof(datalog::RecordHeader)});
+        if (keyLength > 0) iov.push_back({const_cast<char*>(keyBytes), keyLength});
+        if (length > 0) iov.push_back({const_cast<char*>(w.value.data()), length});
+        offsets[i] = pos + sizeof(datalog::RecordHeader) + keyLength;
+        pos += sizeof(datalog::RecordHeader) + keyLength + length;
+    }
+
+    uint64_t offset = diskEnd;
+    for (size_t i = 0; i < iov.size();) {
+        int count = static_cast<int>(std::min<size_t>(IOV_MAX, iov.size() - i));
+        size_t expect = 0;
+        for (int k = 0; k < count; ++k) expect += iov[i + k].iov_len;
+        if (pwritev(diskFd, &iov[i], count, offset) != static_cast<ssize_t>(expect)) {
+            throw std::runtime_error("写入磁盘文件失败");
+        }
+        offset += expect;
+        i += count;
+    }
+    diskEnd = pos;
+
+    // 只有仍指向这条缓冲写入的key改到磁盘位置：同一个key在缓冲区中出现多次时索引指向最后一次，
+    // 之后被删除的key已不在HashMap中
+    for (size_t i = 0; i < writeBuffer.size(); ++i) {
+        const BufferedWrite& w = writeBuffer[i];
+        if (w.flags != datalog::FLAG_PUT) continue;
+        Stored stored = Traits::view(w.key);
+        Location loc;
+        if (!HashMap.find(stored, loc) || loc.segment != kBuffered || loc.offset != i) continue;
+        HashMap.assign(stored, Location{kOnDisk, offsets[i], loc.size});
+    }
+    writeBuffer.clear();
+}
+
+template <typename Key>
+std::vector<char> BasicKVStore<Key>::readFromDisk(long offset, size_t length) {
+    std::vector<char> value(length);
+    if (length > 0 && pread(diskFd, value.data(), length, offset) != static_cast<ssize_t>(length)) {
+        throw std::runtime_error("读取磁盘文件失败");
+    }
+    return value;
+}
+
+template <typename Key>
+std::vector<char> BasicKVStore<Key>::read(const Key& key) {
+    Location loc;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!HashMap.find(Traits::view(key), loc)) return {};
+        if (loc.segment == kBuffered) {
+            return writeBuffer[loc.offset].value;
+        }
+    }
+    // 磁盘文件只追加，锁外读取已落盘的数据是安全的
+    return readFromDisk(static_cast<long>(loc.offset), loc.size);
+}
+
+template <typename Key>
+bool BasicKVStore<Key>::remove(const Key& key) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!HashMap.erase(Traits::view(key))) return false;
+    writeBuffer.push_back(BufferedWrite{key, datalog::FLAG_TOMBSTONE, std::vector<char>()});
+    if (writeBuffer.size() >= bufferLimit) {
+        flushLocked();
+    }
+    return true;
+}
+
+template <typename Key>
+size_t BasicKVStore<Key>::buffered() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return writeBuffer.size();
+}
+
+template <typename Key>
+size_t BasicKVStore<Key>::size() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return HashMap.size();
+}
+
+template <typename Key>
+size_t BasicKVStore<Key>::indexBytes() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return HashMap.memoryBytes() + keyArena.memoryBytes();
+}
+
+template class BasicKVStore<int>;
+template class BasicKVStore<Uuid>;
+template class BasicKVStore<std::string>;
@@ -0,0 +1,139 @@
+#ifndef KV_STORE_H
+#define KV_STORE_H
+
+#include <vector>
+#include <deque>
+#include <string>
+#include <mutex>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <algorithm>
+
+#include "Key.h"
+#include "PackedIndex.h"
+#include "StorageEngine.h"
+
+// 写缓冲引擎：写入先进入内存缓冲区，攒满bufferLimit条后一次写到磁盘文件
+// 缓冲区中的对象直接从内存读取，已落盘的对象用pread读取
+// 磁盘文件使用与ObjectStorage相同的记录格式(DataLog.h)，打开时扫描重建HashMap
+// Key为int、Uuid或std::string，索引形式、哈希和键的编码由KeyTraits<Key>在编译期选择；
+// int和Uuid的键直接存在索引的槽里，字符串键不超过12字节的内联，更长的复制到keyArena
+template <typename Key>
+class BasicKVStore {
+
+private:
+    using Traits = KeyTraits<Key>;
+    using Stored = typename Traits::Stored;
+
+    // 缓冲区中的一条写入，删除以墓碑表示
+    struct BufferedWrite {
+        Key key;
+        uint8_t flags;              // datalog::FLAG_PUT / FLAG_TOMBSTONE
+        std::vector<char> value;
+    };
+
+    // 索引位置的segment字段区分对象在磁盘文件中还是在缓冲区中，缓冲区中的offset是writeBuffer的下标
+    static const uint32_t kOnDisk = 0;
+    static const uint32_t kBuffered = 1;
+    static const unsigned kOffsetBits = 43;   // 只有一个文件，段号只需1位
+
+    PackedIndex<Stored, KeyHash> HashMap;//key到位置的紧凑索引，每个key一个8字节的位置
+    KeyArena keyArena;  //HashMap中长字符串键的字节
+    std::deque<BufferedWrite> writeBuffer;  //写缓冲区
+    size_t bufferLimit; //缓冲区记录数上限
+    int diskFd;         //磁盘文件描述符，追加写用pwritev，读取用pread
+    uint64_t diskEnd;   //磁盘文件末尾
+    std::string disk_filename;
+    mutable std::mutex mutex;
+
+    // 扫描磁盘文件重建HashMap，截掉残缺的尾部
+    void recover();
+
+    // 把缓冲区一次写到磁盘并把对应节点改为磁盘位置，调用方需持有mutex
+    void flushLocked();
+
+    // 插入或覆盖key的位置：key不在HashMap中时索引里的句柄不能指向调用方的内存，先复制到keyArena
+    void assign(const Key& key, const Location& loc);
+
+public:
+    BasicKVStore(size_t buffer_limit, const std::string& disk_filename);
+
+    ~BasicKVStore();
+
+    BasicKVStore(const BasicKVStore&) = delete;
+    BasicKVStore& operator=(const BasicKVStore&) = delete;
+
+    // 写入缓冲区，缓冲区满时落盘
+    bool write(const Key& key, const std::vector<char>& value);
+
+    // 把缓冲区中的写入一次写到磁盘
+    void flushBuffersToDisk();
+
+    std::vector<char> readFromDisk(long offset, size_t length);
+
+    // 缓冲区中的对象从内存读取，其余从磁盘读取；不存在时返回空
+    std::vector<char> read(const Key& key);
+
+    // 删除对象，墓碑随缓冲区落盘
+    bool remove(const Key& key);
+
+    // 缓冲区中的记录数
+    size_t buffered() const;
+
+    // 可访问的对象数
+    size_t size() const;
+
+    // 索引和长键占用的字节
+    size_t indexBytes() const;
+};
+
+// int键的引擎，实现StorageEngine
+class KVStore : public BasicKVStore<int>, public StorageEngine {
+public:
+    KVStore(size_t buffer_limit, const std::string& disk_filename) : BasicKVStore<int>(buffer_limit, disk_filename) {}
+
+    std::string serializeKey(int key) {
+        std::string data(sizeof(key), '\0');
+        std::memcpy(&data[0], &key, sizeof(key));  // 写入key的值
+        return data;
+    }
+
+    int deserializeKey(const std::string& binaryData) {
+        int key = 0;
+        std::memcpy(&key, binaryData.data(), std::min(binaryData.size(), sizeof(key)));  // 读取二进制数据到key
+        return key;
+    }
+
+    // 只支持可按字节复制的类型
+    template<typename T>
+    std::vector<char> serializeValue(const T& value) {
+        static_assert(std::is_trivially_copyable<T>::value, "value must be trivially copyable");
+        std::vector<char> data(sizeof(T));
+        std::memcpy(data.data(), &value, sizeof(T));  // 写入value的内容
+        return data;
+    }
+
+    template<typename T>
+    T deserializeValue(const std::vector<char>& binaryData) {
+        static_assert(std::is_trivially_copyable<T>::value, "value must be trivially copyable");
+        T value{};
+        std::memcpy(&value, binaryData.data(), std::min(binaryData.size(), sizeof(T)));  // 读取二进制数据到value
+        return value;
+    }
+
+    // StorageEngine
+    void put(int key, const std::vector<char>& value) override { write(key, value); }
+    std::vector<char> get(int key) override { return read(key); }
+    void del(int key) override { remove(key); }
+    void flush() override { flushBuffersToDisk(); }
+    size_t size() const override { return BasicKVStore<int>::size(); }
+    const char* name() const override { return "KVStore"; }
+};
+
+// 定义在KVStore.cpp中，只为这几种键实例化
+extern template class BasicKVStore<int>;
+extern template class BasicKVStore<Uuid>;
+extern template class BasicKVStore<std::string>;
+
+#endif // KV_STORE_H
@@ -0,0 +1,183 @@
+#ifndef KEY_H
+#define KEY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "FlatHashMap.h"
+#include "Hash.h"
+
+// int以外的键类型：16字节的UUID和变长字符串
+// KeyTraits<K>在编译期为每种键选择索引中存放的形式、哈希和记录中的编码，引擎只依赖KeyTraits
+
+// 16字节定长键，按两个64位字比较和哈希
+struct Uuid {
+    uint64_t hi;
+    uint64_t lo;
+
+    bool operator==(const Uuid& other) const { return hi == other.hi && lo == other.lo; }
+    bool operator!=(const Uuid& other) const { return !(*this == other); }
+};
+
+// 16字节的字符串键句柄，可平凡复制，能直接放进FlatHashMap和PackedIndex的槽里
+// 不超过kInline字节的键内联存放；更长的键只存长度、前4字节和指针，字节本身由KeyArena或调用方持有
+// 长度和前4字节在同一个8字节字里，多数不相等的键比较一次就能排除，不需要访问指针
+class StringKey {
+public:
+    static const size_t kInline = 12;
+
+    StringKey() : len(0) { std::memset(bytes, 0, sizeof(bytes)); }
+
+    // 长键的句柄直接指向data，data需要在句柄使用期间有效
+    static StringKey view(const char* data, size_t size) {
+        StringKey k;
+        k.len = static_cast<uint32_t>(size);
+        if (size <= kInline) {
+            std::memcpy(k.bytes, data, size);
+        } else {
+            std::memcpy(k.bytes, data, kPrefix);
+            std::memcpy(k.bytes + kPrefix, &data, sizeof(data));
+        }
+        return k;
+    }
+
+    size_t size() const { return len; }
+    bool isInline() const { return len <= kInline; }
+
+    const char* data() const {
+        if (isInline()) return bytes;
+        const char* p;
+        std::memcpy(&p, bytes + kPrefix, sizeof(p));
+        return p;
+    }
+
+    bool operator==(const StringKey& other) const {
+        if (std::memcmp(this, &other, sizeof(len) + kPrefix) != 0) return false;
+        if (isInline()) return std::memcmp(bytes + kPrefix, other.bytes + kPrefix, kInline - kPrefix) == 0;
+        return std::memcmp(data() + kPrefix, other.data() + kPrefix, len - kPrefix) == 0;
+    }
+    bool operator!=(const StringKey& other) const { return !(*this == other); }
+
+private:
+    static const size_t kPrefix = 4;
+
+    uint32_t len;
+    char bytes[kInline];    // 内联的键，未用的字节为0；或前4字节 + 指针
+};
+
+static_assert(sizeof(StringKey) == 16, "StringKey must be 16 bytes");
+
+// 长键的存放区：按块追加，不逐个释放；被删除的长键占用的空间在重新打开时回收
+class KeyArena {
+public:
+    explicit KeyArena(size_t blockSize = 64 << 10) : blockSize(blockSize), used(0), total(0) {}
+
+    KeyArena(const KeyArena&) = delete;
+    KeyArena& operator=(const KeyArena&) = delete;
+
+    const char* copy(const char* data, size_t size) {
+        // 大于块的1/4的键单独分配，当前块继续使用
+        if (size > blockSize / 4) {
+            large.emplace_back(new char[size]);
+            total += size;
+            std::memcpy(large.back().get(), data, size);
+            return large.back().get();
+        }
+        if (blocks.empty() || used + size > blockSize) {
+            blocks.emplace_back(new char[blockSize]);
+            total += blockSize;
+            used = 0;
+        }
+        char* p = blocks.back().get() + used;
+        std::memcpy(p, data, size);
+        used += size;
+        return p;
+    }
+
+    size_t memoryBytes() const { return total; }
+
+private:
+    size_t blockSize;
+    size_t used;      // 最后一块中已用的字节
+    size_t total;
+    std::vector<std::unique_ptr<char[]>> blocks;
+    std::vector<std::unique_ptr<char[]>> large;
+};
+
+// 各键类型的哈希，FlatHashMap和PackedIndex的Hash参数
+struct KeyHash {
+    uint64_t operator()(int key) const { return FlatHash()(key); }
+    uint64_t operator()(const Uuid& key) const {
+        return mix128(key.hi ^ 0xa0761d6478bd642full, key.lo ^ 0xe7037ed1a0b428dbull);
+    }
+    uint64_t operator()(const StringKey& key) const { return hashBytes(key.data(), key.size()); }
+};
+
+// Stored: 索引中存放的形式
+// view: 只用于查找的句柄，不复制键；intern: 插入索引时的句柄，需要时把键复制到arena
+// 记录中的编码：int键放在记录头的key字段，没有额外字节；其他键的记录头key字段是键的字节数，
+// 键的字节紧跟在记录头后、value之前
+template <typename K>
+struct KeyTraits;
+
+template <>
+struct KeyTraits<int> {
+    using Stored = int;
+    static const bool kInterned = false;
+
+    static int view(int key) { return key; }
+    static int intern(int key, KeyArena&) { return key; }
+
+    static int32_t headerKey(int key) { return key; }
+    static uint32_t encodedSize(int) { return 0; }
+    static const char* encodedData(const int&) { return nullptr; }
+    static bool decode(int32_t headerKey, const char*, uint32_t, int& key) {
+        key = headerKey;
+        return true;
+    }
+};
+
+template <>
+struct KeyTraits<Uuid> {
+    using Stored = Uuid;
+    static const bool kInterned = false;
+
+    static Uuid view(const Uuid& key) { return key; }
+    static Uuid intern(const Uuid& key, KeyArena&) { return key; }
+
+    static int32_t headerKey(const Uuid&) { return sizeof(Uuid); }
+    static uint32_t encodedSize(const Uuid&) { return sizeof(Uuid); }
+    static const char* encodedData(const Uuid& key) { return reinterpret_cast<const char*>(&key); }
+    static bool decode(int32_t headerKey, const char* data, uint32_t length, Uuid& key) {
+        if (headerKey != static_cast<int32_t>(sizeof(Uuid)) || length < sizeof(Uuid)) return false;
+        std::memcpy(&key, data, sizeof(Uuid));
+        return true;
+    }
+};
+
+template <>
+struct KeyTraits<std::string> {
+    using Stored = StringKey;
+    static const bool kInterned = true;
+
+    static StringKey view(const std::string& key) { return StringKey::view(key.data(), key.size()); }
+    static StringKey intern(const std::string& key, KeyArena& arena) {
+        if (key.size() <= StringKey::kInline) return view(key);
+        return StringKey::view(arena.copy(key.data(), key.size()), key.size());
+    }
+
+    static int32_t headerKey(const std::string& key) { return static_cast<int32_t>(key.size()); }
+    static uint32_t encodedSize(const std::string& key) { return static_cast<uint32_t>(key.size()); }
+    static const char* encodedData(const std::string& key) { return key.data(); }
+    static bool decode(int32_t headerKey, const char* data, uint32_t length, std::string& key) {
+        if (headerKey < 0 || static_cast<uint32_t>(headerKey) > length) return false;
+        key.assign(data, static_cast<size_t>(headerKey));
+        return true;
+    }
+};
+
+#endif // KEY_H
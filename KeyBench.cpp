@@ -0,0 +1,193 @@
+#include "KVStore.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <malloc.h>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// 键类型测试：int、16字节UUID、不超过12字节的短字符串(内联)和32字节左右的长字符串(存在KeyArena中)
+// 1. 索引：PackedIndex<Stored, KeyHash>每个key的内存占用(含长键的字节)、插入和命中/未命中查找的耗时，
+//    字符串另与std::unordered_map<std::string, Location>对比
+// 2. 引擎：BasicKVStore<Key>写入和随机读的ops/s
+// 用法: KeyBench [key数量] [查找次数] [对象大小]
+
+static size_t heapBytes() {
+    struct mallinfo2 info = mallinfo2();
+    return info.uordblks + info.hblkhd;
+}
+
+static double elapsedNs(std::chrono::steady_clock::time_point start, size_t ops) {
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / ops;
+}
+
+static std::vector<int> intKeys(size_t n, uint64_t seed) {
+    std::vector<int> keys(n);
+    for (size_t i = 0; i < n; ++i) keys[i] = static_cast<int>(i + seed * n);
+    std::shuffle(keys.begin(), keys.end(), std::mt19937(3));
+    return keys;
+}
+
+static std::vector<Uuid> uuidKeys(size_t n, uint64_t seed) {
+    std::mt19937_64 rng(seed);
+    std::vector<Uuid> keys(n);
+    for (Uuid& k : keys) k = Uuid{rng(), rng()};
+    return keys;
+}
+
+// 短字符串如"u12345678"，长字符串如"tenant-07/bucket-3/object-000012345678"
+static std::vector<std::string> stringKeys(size_t n, uint64_t seed, bool longKeys) {
+    std::vector<std::string> keys(n);
+    char buf[64];
+    for (size_t i = 0; i < n; ++i) {
+        uint64_t id = i + seed * n;
+        if (longKeys) {
+            std::snprintf(buf, sizeof(buf), "tenant-%02u/bucket-%u/object-%012llu", static_cast<unsigned>(id % 97),
+                          static_cast<unsigned>(id % 13), static_cast<unsigned long long>(id));
+        } else {
+            std::snprintf(buf, sizeof(buf), "u%llu", static_cast<unsigned long long>(id));
+        }
+        keys[i] = buf;
+    }
+    std::shuffle(keys.begin(), keys.end(), std::mt19937(3));
+    return keys;
+}
+
+template <typename Key>
+static void runIndex(const char* name, const std::vector<Key>& keys, const std::vector<Key>& absent, size_t lookups) {
+    using Traits = KeyTraits<Key>;
+    size_t before = heapBytes();
+    auto* index = new PackedIndex<typename Traits::Stored, KeyHash>(27);
+    auto* arena = new KeyArena();
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < keys.size(); ++i) {
+        index->assign(Traits::intern(keys[i], *arena), Location{1, i * 64 & ((1u << 26) - 1), 100});
+    }
+    double insertNs = elapsedNs(start, keys.size());
+    double bytesPerKey = static_cast<double>(heapBytes() - before) / keys.size();
+
+    std::mt19937 rng(11);
+    std::uniform_int_distribution<size_t> pick(0, keys.size() - 1);
+    std::vector<size_t> order(lookups);
+    for (size_t& i : order) i = pick(rng);
+
+    uint64_t checksum = 0;
+    Location loc;
+    start = std::chrono::steady_clock::now();
+    for (size_t i : order) checksum += index->find(Traits::view(keys[i]), loc) ? loc.size : 0;
+    double hitNs = elapsedNs(start, lookups);
+    start = std::chrono::steady_clock::now();
+    for (size_t i : order) checksum += index->find(Traits::view(absent[i]), loc);
+    double missNs = elapsedNs(start, lookups);
+
+    std::printf("%s %.1f %.1f %.1f %.1f%s\n", name, bytesPerKey, insertNs, hitNs, missNs,
+                checksum != lookups * 100 ? " (unexpected)" : "");
+    delete index;
+    delete arena;
+}
+
+static void runStringMap(const char* name, const std::vector<std::string>& keys,
+                         const std::vector<std::string>& absent, size_t lookups) {
+    size_t before = heapBytes();
+    auto* map = new std::unordered_map<std::string, Location>();
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < keys.size(); ++i) (*map)[keys[i]] = Location{1, i * 64 & ((1u << 26) - 1), 100};
+    double insertNs = elapsedNs(start, keys.size());
+    double bytesPerKey = static_cast<double>(heapBytes() - before) / keys.size();
+
+    std::mt19937 rng(11);
+    std::uniform_int_distribution<size_t> pick(0, keys.size() - 1);
+    std::vector<size_t> order(lookups);
+    for (size_t& i : order) i = pick(rng);
+
+    uint64_t checksum = 0;
+    start = std::chrono::steady_clock::now();
+    for (size_t i : order) {
+        auto it = map->find(keys[i]);
+        if (it != map->end()) checksum += it->second.size;
+    }
+    double hitNs = elapsedNs(start, lookups);
+    start = std::chrono::steady_clock::now();
+    for (size_t i : order) checksum += map->count(absent[i]);
+    double missNs = elapsedNs(start, lookups);
+
+    std::printf("%s %.1f %.1f %.1f %.1f%s\n", name, bytesPerKey, insertNs, hitNs, missNs,
+                checksum != lookups * 100 ? " (unexpected)" : "");
+    delete map;
+}
+
+template <typename Key>
+static void runEngine(const char* name, const std::vector<Key>& keys, size_t lookups, size_t valueSize) {
+    const std::string path = "key_bench.dat";
+    std::remove(path.c_str());
+    {
+        BasicKVStore<Key> store(1024, path);
+        std::vector<char> value(valueSize, 'k');
+        auto start = std::chrono::steady_clock::now();
+        for (const Key& key : keys) store.write(key, value);
+        store.flushBuffersToDisk();
+        double writeNs = elapsedNs(start, keys.size());
+
+        std::mt19937 rng(13);
+        std::uniform_int_distribution<size_t> pick(0, keys.size() - 1);
+        std::vector<size_t> order(lookups);
+        for (size_t& i : order) i = pick(rng);
+        size_t bytes = 0;
+        start = std::chrono::steady_clock::now();
+        for (size_t i : order) bytes += store.read(keys[i]).size();
+        double readNs = elapsedNs(start, lookups);
+
+        std::printf("%s %.0f %.0f %.1f%s\n", name, 1e9 / writeNs, 1e9 / readNs,
+                    static_cast<double>(store.indexBytes()) / keys.size(),
+                    bytes != lookups * valueSize ? " (unexpected)" : "");
+    }
+    std::remove(path.c_str());
+}
+
+int main(int argc, char* argv[]) {
+    size_t count = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 2000000;
+    size_t lookups = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 2000000;
+    size_t valueSize = argc > 3 ? std::strtoull(argv[3], nullptr, 10) : 100;
+
+    std::vector<int> ints = intKeys(count, 0);
+    std::vector<Uuid> uuids = uuidKeys(count, 1);
+    std::vector<std::string> shorts = stringKeys(count, 0, false);
+    std::vector<std::string> longs = stringKeys(count, 0, true);
+
+    std::printf("index bytes/key insert_ns hit_ns miss_ns\n");
+    {
+        std::vector<int> absent = intKeys(count, 1);
+        runIndex("int", ints, absent, lookups);
+    }
+    {
+        std::vector<Uuid> absent = uuidKeys(count, 2);
+        runIndex("uuid", uuids, absent, lookups);
+    }
+    {
+        std::vector<std::string> absent = stringKeys(count, 1, false);
+        runIndex("string12", shorts, absent, lookups);
+        runStringMap("unordered_map12", shorts, absent, lookups);
+    }
+    {
+        std::vector<std::string> absent = stringKeys(count, 1, true);
+        runIndex("string38", longs, absent, lookups);
+        runStringMap("unordered_map38", longs, absent, lookups);
+    }
+
+    // 引擎测试按key数量的1/4，读写都经过文件
+    size_t engineKeys = count / 4;
+    ints.resize(engineKeys);
+    uuids.resize(engineKeys);
+    shorts.resize(engineKeys);
+    longs.resize(engineKeys);
+    std::printf("\nengine write_ops/s read_ops/s index_bytes/key\n");
+    runEngine("int", ints, lookups / 4, valueSize);
+    runEngine("uuid", uuids, lookups / 4, valueSize);
+    runEngine("string12", shorts, lookups / 4, valueSize);
+    runEngine("string38", longs, lookups / 4, valueSize);
+    return 0;
+}
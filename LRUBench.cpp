@@ -0,0 +1,83 @@
+#include "LRUCache.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <random>
+
+// 缓存队列微基准：单分片缓存上插入、命中和淘汰(缓存已满时插入新key)的每次操作耗时
+// 和堆分配次数；所有条目共享同一个负载句柄，测到的只是哈希表、策略队列和条目本身的开销
+// 用法: LRUBench [条目数量]
+
+static std::atomic<size_t> allocCount(0);
+
+// 计数用的替换版本，禁止内联：内联后GCC会把malloc/free与new/delete配对检查，误报-Wmismatched-new-delete
+__attribute__((noinline)) void* operator new(size_t size) {
+    allocCount.fetch_add(1, std::memory_order_relaxed);
+    void* p = std::malloc(size ? size : 1);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+
+__attribute__((noinline)) void operator delete(void* p) noexcept { std::free(p); }
+__attribute__((noinline)) void operator delete(void* p, size_t) noexcept { std::free(p); }
+
+static const size_t kValueSize = 64;
+
+struct Result {
+    double ns;
+    double allocs;
+};
+
+template <typename Fn>
+static Result measure(size_t ops, Fn fn) {
+    size_t allocsBefore = allocCount.load();
+    auto start = std::chrono::steady_clock::now();
+    fn();
+    double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    return {ns / ops, static_cast<double>(allocCount.load() - allocsBefore) / ops};
+}
+
+static void run(CachePolicy policy, size_t entries) {
+    LRUCache cache(entries * LRUCache::charge(kValueSize), 1, policy);
+    char* buf = nullptr;
+    ValueRef value = ValueRef::allocate(kValueSize, &buf);
+
+    std::vector<int> keys(entries);
+    for (size_t i = 0; i < entries; ++i) keys[i] = static_cast<int>(i);
+    std::shuffle(keys.begin(), keys.end(), std::mt19937(7));
+
+    // 插入到缓存正好放满，包含哈希表扩容的均摊开销
+    Result insert = measure(entries, [&]() {
+        for (int key : keys) cache.put(key, value);
+    });
+
+    std::vector<int> hits(keys);
+    std::shuffle(hits.begin(), hits.end(), std::mt19937(9));
+    size_t found = 0;
+    Result hit = measure(entries, [&]() {
+        for (int key : hits) found += !cache.get(key).empty();
+    });
+
+    // 缓存已满，每次插入新key都淘汰一个条目
+    Result evict = measure(entries, [&]() {
+        for (size_t i = 0; i < entries; ++i) cache.put(static_cast<int>(2 * entries + i), value);
+    });
+
+    std::printf("%s %zu %.1f %.2f %.1f %.2f %.1f %.2f%s\n", cachePolicyName(policy), entries,
+                insert.ns, insert.allocs, hit.ns, hit.allocs, evict.ns, evict.allocs,
+                found == 0 ? " (no hits)" : "");
+}
+
+int main(int argc, char* argv[]) {
+    size_t entries = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+
+    std::printf("policy entries insert_ns allocs hit_ns allocs evict_ns allocs\n");
+    for (CachePolicy policy : {CachePolicy::LRU, CachePolicy::SLRU, CachePolicy::TinyLFU}) {
+        run(policy, entries);
+    }
+    return 0;
+}
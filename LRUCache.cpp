@@ -0,0 +1,197 @@
+#include "LRUCache.h"
+
+LRUCache::LRUCache(size_t capacityBytes, size_t shardCount, CachePolicy policy)
+    : policyType(policy) {
+    if (shardCount == 0) {
+        shardCount = capacityBytes / kMinShardCapacity;
+        if (shardCount > kMaxShards) shardCount = kMaxShards;
+    }
+    // 分片数取2的幂，便于用掩码选择分片
+    size_t n = 1;
+    while (n * 2 <= shardCount) n *= 2;
+
+    for (size_t i = 0; i < n; ++i) {
+        std::unique_ptr<Shard> shard(new Shard);
+        // 容量均分，余数分给前面的分片
+        shard->capacity = capacityBytes / n + (i < capacityBytes % n ? 1 : 0);
+        shard->usage = 0;
+        shard->hits = shard->misses = shard->evictions = shard->rejected = 0;
+        shard->policy = EvictionPolicy::create(policy, shard->capacity);
+        shards.push_back(std::move(shard));
+    }
+}
+
+ValueRef LRUCache::get(int key) {
+    Shard& shard = shardFor(key);
+    std::lock_guard<std::mutex> lock(shard.cacheMutex);
+    return getLocked(shard, key);
+}
+
+ValueRef LRUCache::getLocked(Shard& shard, int key) {
+    auto it = shard.itemMap.find(key);
+    if (it == shard.itemMap.end()) {
+        ++shard.misses;
+        shard.policy->onMiss(key);
+        return {};  // 如果缓存中不存在该项，返回空值
+    }
+
+    ++shard.hits;
+    shard.policy->onHit(*it->second);
+    return it->second->value;
+}
+
+void LRUCache::getMany(const std::vector<int>& keys, std::vector<ValueRef>& values) {
+    values.resize(keys.size());
+    std::vector<uint32_t> shardOf(keys.size());
+    for (size_t i = 0; i < keys.size(); ++i) {
+        shardOf[i] = hashKey(keys[i]) & (shards.size() - 1);
+    }
+    std::vector<uint32_t> order;
+    orderByShard(shardOf, shards.size(), order);
+
+    size_t g = 0;
+    while (g < order.size()) {
+        uint32_t s = shardOf[order[g]];
+        Shard& shard = *shards[s];
+        std::lock_guard<std::mutex> lock(shard.cacheMutex);
+        for (; g < order.size() && shardOf[order[g]] == s; ++g) {
+            values[order[g]] = getLocked(shard, keys[order[g]]);
+        }
+    }
+}
+
+void LRUCache::putMany(std::vector<std::pair<int, ValueRef>>& items) {
+    std::vector<uint32_t> shardOf(items.size());
+    for (size_t i = 0; i < items.size(); ++i) {
+        shardOf[i] = hashKey(items[i].first) & (shards.size() - 1);
+    }
+    std::vector<uint32_t> order;
+    orderByShard(shardOf, shards.size(), order);
+
+    size_t g = 0;
+    while (g < order.size()) {
+        uint32_t s = shardOf[order[g]];
+        Shard& shard = *shards[s];
+        std::lock_guard<std::mutex> lock(shard.cacheMutex);
+        for (; g < order.size() && shardOf[order[g]] == s; ++g) {
+            std::pair<int, ValueRef>& item = items[order[g]];
+            putLocked(shard, item.first, std::move(item.second));
+        }
+    }
+}
+
+void LRUCache::put(int key, const std::vector<char>& value) {
+    put(key, ValueRef::copyOf(value.data(), value.size()));
+}
+
+void LRUCache::put(int key, std::vector<char>&& value) {
+    put(key, ValueRef::fromVector(std::move(value)));
+}
+
+LRUCache::Shard::~Shard() {
+    for (const auto& kv : itemMap) freeEntry(kv.second);
+}
+
+CacheEntry* LRUCache::newEntry() {
+    SlabAllocator<CacheEntry> alloc;
+    CacheEntry* e = alloc.allocate(1);
+    return new (e) CacheEntry();
+}
+
+void LRUCache::freeEntry(CacheEntry* e) {
+    e->~CacheEntry();
+    SlabAllocator<CacheEntry>().deallocate(e, 1);
+}
+
+void LRUCache::eraseEntry(Shard& shard, CacheEntry& e) {
+    shard.policy->onErase(e);
+    shard.usage -= e.charge;
+    shard.itemMap.erase(e.key);
+    freeEntry(&e);
+}
+
+void LRUCache::evictOne(Shard& shard) {
+    eraseEntry(shard, *shard.policy->victim());
+    ++shard.evictions;
+}
+
+void LRUCache::put(int key, ValueRef&& value) {
+    Shard& shard = shardFor(key);
+    std::lock_guard<std::mutex> lock(shard.cacheMutex);
+    putLocked(shard, key, std::move(value));
+}
+
+void LRUCache::putLocked(Shard& shard, int key, ValueRef&& value) {
+    size_t need = charge(value.size());
+    auto it = shard.itemMap.find(key);
+
+    if (!value) {
+        if (it != shard.itemMap.end()) {
+            eraseEntry(shard, *it->second);
+        }
+        return;
+    }
+
+    // 超过整个分片容量的对象不缓存，同时丢弃旧值避免读到过期数据
+    if (need > shard.capacity) {
+        ++shard.rejected;
+        if (it != shard.itemMap.end()) {
+            eraseEntry(shard, *it->second);
+        }
+        return;
+    }
+
+    if (it != shard.itemMap.end()) {
+        CacheEntry& e = *it->second;
+        size_t oldCharge = e.charge;
+        e.value = std::move(value);
+        e.charge = need;
+        shard.usage = shard.usage - oldCharge + need;
+        shard.policy->onUpdate(e, oldCharge);
+        // 新值更大时按策略淘汰其他条目
+        while (shard.usage > shard.capacity) {
+            evictOne(shard);
+        }
+        return;
+    }
+
+    // 淘汰直到新对象能放下
+    while (shard.usage + need > shard.capacity) {
+        evictOne(shard);
+    }
+
+    CacheEntry& e = *newEntry();
+    shard.itemMap.emplace(key, &e);
+    e.key = key;
+    e.value = std::move(value);
+    e.charge = need;
+    e.segment = 0;
+    e.fresh = false;
+    shard.usage += need;
+    shard.policy->onInsert(e);
+}
+
+void LRUCache::print() {
+    for (auto& shard : shards) {
+        std::lock_guard<std::mutex> lock(shard->cacheMutex);
+        shard->policy->forEach([](const CacheEntry& e) {
+            std::cout << e.key << ":" << e.value.size() << " ";
+        });
+    }
+    std::cout << std::endl;
+}
+
+LRUCache::Stats LRUCache::stats() {
+    Stats s = {0, 0, 0, 0, 0, 0, 0};
+    for (auto& shard : shards) {
+        std::lock_guard<std::mutex> lock(shard->cacheMutex);
+        s.capacityBytes += shard->capacity;
+        s.residentBytes += shard->usage;
+        s.entries += shard->itemMap.size();
+        s.hits += shard->hits;
+        s.misses += shard->misses;
+        s.evictions += shard->evictions;
+        s.rejected += shard->rejected;
+    }
+    return s;
+}
@@ -0,0 +1,101 @@
+#ifndef LRU_CACHE_H
+#define LRU_CACHE_H
+
+#include <iostream>
+#include <vector>
+#include <mutex>
+#include <memory>
+#include <cstdint>
+
+#include "FlatHashMap.h"
+#include "Hash.h"
+#include "SlabAllocator.h"
+#include "ValueRef.h"
+#include "EvictionPolicy.h"
+
+// 分片缓存：按key哈希分成多个独立加锁的分片，不同分片上的读写互不阻塞
+// 容量按字节计算，每个条目占用 负载大小 + kEntryOverhead
+// 淘汰顺序由每个分片的EvictionPolicy决定，默认LRU
+class LRUCache {
+public:
+    // 每个条目除负载外的固定开销估算：条目(含队列链接)、哈希表的槽、句柄的控制块
+    static const size_t kEntryOverhead =
+        sizeof(CacheEntry)                                     // 条目，策略队列的链接在条目内
+        + sizeof(int) + 3 * sizeof(void*)                      // 哈希表的槽和控制字节(按负载因子折算)
+        + sizeof(std::vector<char>) + 2 * sizeof(long);        // 共享缓冲区的控制块
+
+    struct Stats {
+        size_t capacityBytes;   // 总容量
+        size_t residentBytes;   // 已占用字节(含固定开销)
+        size_t entries;         // 条目数
+        uint64_t hits;
+        uint64_t misses;
+        uint64_t evictions;     // 因容量不足被淘汰的条目
+        uint64_t rejected;      // 超过分片容量而拒绝缓存的对象
+    };
+
+    // capacityBytes为总字节容量，shardCount为0时根据容量自动选择分片数
+    explicit LRUCache(size_t capacityBytes, size_t shardCount = 0,
+                      CachePolicy policy = CachePolicy::LRU);
+
+    // 命中时返回共享的句柄，未命中返回不引用对象的空句柄；空对象也可以命中
+    ValueRef get(int key);
+    // value不引用对象时删除key的条目并释放其空间(用于删除和失效)，不会占用槽位
+    void put(int key, ValueRef&& value);
+    void put(int key, const ValueRef& value) { put(key, ValueRef(value)); }
+    void put(int key, std::vector<char>&& value);
+    void put(int key, const std::vector<char>& value);
+
+    // 批量查找，values与keys一一对应，未命中的位置为空句柄；每个分片只加一次锁
+    void getMany(const std::vector<int>& keys, std::vector<ValueRef>& values);
+    // 批量放入，同一分片的条目在一次加锁内完成，同一key按出现顺序覆盖；空句柄的含义同put
+    void putMany(std::vector<std::pair<int, ValueRef>>& items);
+    void print();
+
+    Stats stats();
+    size_t shardCount() const { return shards.size(); }
+    CachePolicy policy() const { return policyType; }
+
+    // 单个条目的占用字节
+    static size_t charge(size_t payload) { return payload + kEntryOverhead; }
+
+private:
+    struct Shard {
+        size_t capacity;      // 分片容量(字节)
+        size_t usage;         // 已占用字节
+        uint64_t hits;
+        uint64_t misses;
+        uint64_t evictions;
+        uint64_t rejected;
+        // 开放寻址表，key到条目的指针；条目从slab分配，地址固定，策略队列可以直接引用
+        FlatHashMap<int, CacheEntry*> itemMap;
+        std::unique_ptr<EvictionPolicy> policy;       // 淘汰策略，记录缓存顺序
+        std::mutex cacheMutex;  // 用于多线程同步
+        ~Shard();
+    };
+
+    static const size_t kMaxShards = 64;                 // 分片数上限
+    static const size_t kMinShardCapacity = 4 << 20;     // 每个分片至少4MB
+
+    Shard& shardFor(int key) {
+        return *shards[hashKey(key) & (shards.size() - 1)];
+    }
+
+    // 查找和放入的实现，调用方需持有分片锁
+    ValueRef getLocked(Shard& shard, int key);
+    void putLocked(Shard& shard, int key, ValueRef&& value);
+
+    // 淘汰策略选出的条目，调用方需持有分片锁
+    void evictOne(Shard& shard);
+
+    static CacheEntry* newEntry();
+    static void freeEntry(CacheEntry* e);
+
+    // 删除条目并释放，调用方需持有分片锁
+    void eraseEntry(Shard& shard, CacheEntry& e);
+
+    CachePolicy policyType;
+    std::vector<std::unique_ptr<Shard>> shards;
+};
+
+#endif // LRU_CACHE_H
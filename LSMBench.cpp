@@ -0,0 +1,74 @@
+#include "LSMStore.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+
+// 日志结构合并引擎测试：按随机顺序写入key，等待后台写出和合并完成后
+// 输出写放大(写入磁盘的字节 / 用户写入的字节，分别列出WAL、内存表写出和合并)、各层的文件数和大小，
+// 以及命中和未命中时点查的平均、p50和p99延迟；只写入偶数key，未命中的奇数key落在表文件的key范围内，由过滤器排除
+// 用法: LSMBench [key数量] [对象大小] [点查次数] [每key过滤器位数]
+
+static double micros(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+}
+
+static void latency(const char* label, LSMStore& store, int parity, int keys, size_t lookups) {
+    std::mt19937 rng(7);
+    std::uniform_int_distribution<int> pick(0, keys - 1);
+    std::vector<double> samples(lookups);
+    size_t found = 0;
+    for (size_t i = 0; i < lookups; ++i) {
+        auto start = std::chrono::steady_clock::now();
+        found += !store.get(pick(rng) * 2 + parity).empty();
+        samples[i] = micros(start);
+    }
+    double total = 0;
+    for (double s : samples) total += s;
+    std::sort(samples.begin(), samples.end());
+    std::printf("%s avg %.2f us p50 %.2f us p99 %.2f us found %zu/%zu\n", label, total / lookups,
+                samples[lookups / 2], samples[lookups * 99 / 100], found, lookups);
+}
+
+int main(int argc, char* argv[]) {
+    int keys = argc > 1 ? std::atoi(argv[1]) : 2000000;
+    size_t valueSize = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 100;
+    size_t lookups = argc > 3 ? std::strtoull(argv[3], nullptr, 10) : 200000;
+    unsigned bitsPerKey = argc > 4 ? static_cast<unsigned>(std::atoi(argv[4])) : 10;
+    const std::string path = "lsm_bench.dat";
+
+    LSMStore::destroy(path);
+    LSMStore::Options options;
+    options.filterBitsPerKey = bitsPerKey;
+    {
+        LSMStore store(path, options);
+        std::vector<int> order(keys);
+        for (int i = 0; i < keys; ++i) order[i] = i * 2;
+        std::shuffle(order.begin(), order.end(), std::mt19937(3));
+        std::vector<char> value(valueSize, 'l');
+
+        auto start = std::chrono::steady_clock::now();
+        for (int key : order) store.put(key, value);
+        double loadUs = micros(start);
+        store.waitIdle();
+        double settleUs = micros(start);
+
+        LSMStore::Stats s = store.stats();
+        double user = static_cast<double>(s.userBytes);
+        std::printf("load %.0f ops/s, including compaction %.0f ops/s\n", keys / loadUs * 1e6, keys / settleUs * 1e6);
+        std::printf("write amplification %.2f (wal %.2f flush %.2f compaction %.2f), compactions %llu\n",
+                    (s.walBytes + s.flushBytes + s.compactionBytes) / user, s.walBytes / user, s.flushBytes / user,
+                    s.compactionBytes / user, static_cast<unsigned long long>(s.compactions));
+        for (size_t level = 0; level < s.levelFiles.size(); ++level) {
+            if (s.levelFiles[level] == 0) continue;
+            std::printf("L%zu files %zu bytes %.1f MB\n", level, s.levelFiles[level], s.levelBytes[level] / 1048576.0);
+        }
+
+        latency("hit", store, 0, keys, lookups);
+        latency("miss", store, 1, keys, lookups);
+    }
+    LSMStore::destroy(path);
+    return 0;
+}
@@ -0,0 +1,957 @@
+#include "LSMStore.h"
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <set>
+#include <stdexcept>
+
+#include "Crc32c.h"
+#include "DataLog.h"
+
+// 表文件格式: [数据块...][过滤器][块索引][TableFooter]
+// 数据块: 按key递增的记录 [int32 key][uint8 flags][uint32 length][value]，末尾是整块的CRC32C
+// 过滤器: BloomFilter的块数组；块索引: 每个数据块一个BlockHandle
+// manifest格式: [ManifestHeader]，每层 [uint64 文件数][uint64 文件号...]，末尾是以上全部内容的CRC32C
+namespace {
+
+const char kTableMagic[8] = {'O', 'S', 'L', 'S', 'M', 'T', 'B', '1'};
+const char kManifestMagic[8] = {'O', 'S', 'L', 'S', 'M', 'M', 'F', '1'};
+const uint32_t kManifestVersion = 1;
+
+const size_t kEntryHeader = sizeof(int32_t) + sizeof(uint8_t) + sizeof(uint32_t);
+
+// 内存表中每个条目除value以外的估算开销(map节点和vector)
+const size_t kMemEntryOverhead = 80;
+
+// 表文件写出时的缓冲区大小
+const size_t kWriteBuffer = 1 << 20;
+
+struct TableFooter {
+    char magic[8];
+    uint64_t indexOffset;
+    uint64_t indexCount;
+    uint64_t filterOffset;
+    uint64_t filterBlocks;
+    uint64_t filterKeys;
+    uint64_t entries;
+    int32_t smallest;
+    int32_t largest;
+    uint32_t crc;        // 过滤器、块索引和尾部crc之前字段的CRC32C
+    uint32_t reserved;
+};
+
+struct ManifestHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t levels;
+    uint64_t nextFile;
+    uint64_t logNumber;
+};
+
+void readAt(int fd, void* data, size_t len, uint64_t offset, const std::string& path) {
+    if (len == 0) return;
+    if (pread(fd, data, len, static_cast<off_t>(offset)) != static_cast<ssize_t>(len)) {
+        throw std::runtime_error("读取文件失败: " + path);
+    }
+}
+
+void writeFully(int fd, const char* data, size_t len, const std::string& path) {
+    if (len > 0 && ::write(fd, data, len) != static_cast<ssize_t>(len)) {
+        throw std::runtime_error("写入文件失败: " + path);
+    }
+}
+
+template <typename T>
+void appendPod(std::vector<char>& buf, const T& v) {
+    const char* p = reinterpret_cast<const char*>(&v);
+    buf.insert(buf.end(), p, p + sizeof(T));
+}
+
+// 按文件号列出 filename.NNNNNN<suffix>
+std::map<uint64_t, std::string> listFiles(const std::string& filename, const std::string& suffix) {
+    std::string dir = ".";
+    std::string base = filename;
+    size_t slash = filename.rfind('/');
+    if (slash != std::string::npos) {
+        dir = slash == 0 ? "/" : filename.substr(0, slash);
+        base = filename.substr(slash + 1);
+    }
+    std::string prefix = base + ".";
+    std::string pathPrefix = slash == std::string::npos ? "" : filename.substr(0, slash + 1);
+
+    std::map<uint64_t, std::string> found;
+    DIR* d = opendir(dir.c_str());
+    if (!d) return found;
+    while (struct dirent* ent = readdir(d)) {
+        std::string name = ent->d_name;
+        if (name.size() <= prefix.size() + suffix.size() || name.compare(0, prefix.size(), prefix) != 0
+            || name.compare(name.size() - suffix.size(), suffix.size(), suffix) != 0) {
+            continue;
+        }
+        std::string digits = name.substr(prefix.size(), name.size() - prefix.size() - suffix.size());
+        if (digits.empty() || digits.size() > 18 || !std::all_of(digits.begin(), digits.end(), ::isdigit)) continue;
+        found[std::stoull(digits)] = pathPrefix + name;
+    }
+    closedir(d);
+    return found;
+}
+
+} // namespace
+
+// 合并用的有序记录来源，value指针在next之前有效
+class LSMStore::Source {
+public:
+    virtual ~Source() {}
+    virtual bool valid() const = 0;
+    virtual void next() = 0;
+
+    int key() const { return curKey; }
+    uint8_t flags() const { return curFlags; }
+    const char* value() const { return curValue; }
+    uint32_t length() const { return curLength; }
+
+protected:
+    int curKey = 0;
+    uint8_t curFlags = 0;
+    const char* curValue = nullptr;
+    uint32_t curLength = 0;
+};
+
+// 内存表的key和flags的副本，只用于统计对象数，不带value
+class LSMStore::MemSource : public Source {
+public:
+    explicit MemSource(const MemTable& table) : pos(0) {
+        items.reserve(table.entries.size());
+        for (const auto& kv : table.entries) items.emplace_back(kv.first, kv.second.flags);
+        load();
+    }
+    bool valid() const override { return pos < items.size(); }
+    void next() override {
+        ++pos;
+        load();
+    }
+
+private:
+    void load() {
+        if (pos < items.size()) {
+            curKey = items[pos].first;
+            curFlags = items[pos].second;
+        }
+    }
+
+    std::vector<std::pair<int, uint8_t>> items;
+    size_t pos;
+};
+
+// 顺序读一个表文件，使用单独的描述符以便提示顺序预读
+class LSMStore::TableSource : public Source {
+public:
+    explicit TableSource(TablePtr t) : table(std::move(t)), blockIndex(0), pos(0), ok(false) {
+        fd = open(table->path.c_str(), O_RDONLY);
+        if (fd < 0) throw std::runtime_error("无法打开表文件: " + table->path);
+        posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+        try {
+            loadBlock();
+        } catch (...) {
+            close(fd);
+            throw;
+        }
+    }
+    ~TableSource() override { close(fd); }
+
+    bool valid() const override { return ok; }
+    void next() override {
+        if (!parse()) {
+            ++blockIndex;
+            loadBlock();
+        }
+    }
+
+private:
+    void loadBlock() {
+        ok = false;
+        for (; blockIndex < table->index.size(); ++blockIndex) {
+            table->readBlock(fd, table->index[blockIndex], block);
+            pos = 0;
+            if (parse()) return;
+        }
+    }
+
+    // 解析pos处的记录并前进到下一条，块内没有更多记录时返回false
+    bool parse() {
+        size_t end = block.size() - sizeof(uint32_t);
+        if (pos + kEntryHeader > end) return false;
+        const char* p = block.data() + pos;
+        std::memcpy(&curKey, p, sizeof(int32_t));
+        curFlags = static_cast<uint8_t>(p[sizeof(int32_t)]);
+        std::memcpy(&curLength, p + sizeof(int32_t) + sizeof(uint8_t), sizeof(uint32_t));
+        if (curLength > end - pos - kEntryHeader) throw std::runtime_error("表文件损坏: " + table->path);
+        curValue = p + kEntryHeader;
+        pos += kEntryHeader + curLength;
+        ok = true;
+        return true;
+    }
+
+    TablePtr table;
+    int fd;
+    size_t blockIndex;
+    std::vector<char> block;
+    size_t pos;
+    bool ok;
+};
+
+// 依次读一层中key范围互不重叠的多个表文件
+class LSMStore::LevelSource : public Source {
+public:
+    explicit LevelSource(std::vector<TablePtr> tables) : tables(std::move(tables)), nextTable(0) { advance(); }
+
+    bool valid() const override { return cur && cur->valid(); }
+    void next() override {
+        cur->next();
+        if (!cur->valid()) advance();
+        copy();
+    }
+
+private:
+    void advance() {
+        cur.reset();
+        while (nextTable < tables.size()) {
+            cur.reset(new TableSource(tables[nextTable++]));
+            if (cur->valid()) break;
+        }
+        copy();
+    }
+
+    void copy() {
+        if (!valid()) return;
+        curKey = cur->key();
+        curFlags = cur->flags();
+        curValue = cur->value();
+        curLength = cur->length();
+    }
+
+    std::vector<TablePtr> tables;
+    size_t nextTable;
+    std::unique_ptr<TableSource> cur;
+};
+
+// 多路归并：来源按从新到旧排列，同一key只输出最新来源中的记录
+// 来源只有L0的几个文件和每层一个，逐个比较比维护堆更简单
+class LSMStore::MergeIterator {
+public:
+    explicit MergeIterator(std::vector<std::unique_ptr<Source>> sources) : sources(std::move(sources)), cur(nullptr) {
+        findNext();
+    }
+
+    bool valid() const { return cur != nullptr; }
+    const Source& top() const { return *cur; }
+
+    void next() {
+        int key = cur->key();
+        for (auto& s : sources) {
+            if (s->valid() && s->key() == key) s->next();
+        }
+        findNext();
+    }
+
+private:
+    void findNext() {
+        cur = nullptr;
+        for (auto& s : sources) {
+            if (s->valid() && (cur == nullptr || s->key() < cur->key())) cur = s.get();
+        }
+    }
+
+    std::vector<std::unique_ptr<Source>> sources;
+    Source* cur;
+};
+
+// 按key递增的顺序写一个表文件，finish之前销毁时删除未完成的文件
+class LSMStore::TableWriter {
+public:
+    TableWriter(uint64_t id, const std::string& path, const Options& options)
+        : id(id), path(path), options(options), offset(0), smallest(0), largest(0), entries(0) {
+        fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0) throw std::runtime_error("无法创建表文件: " + path);
+        out.reserve(kWriteBuffer);
+    }
+
+    ~TableWriter() {
+        if (fd >= 0) {
+            close(fd);
+            unlink(path.c_str());
+        }
+    }
+
+    void add(int key, uint8_t flags, const char* value, uint32_t length) {
+        if (entries == 0) smallest = key;
+        largest = key;
+        ++entries;
+        if (options.filterBitsPerKey > 0) keys.push_back(key);
+        appendPod(block, static_cast<int32_t>(key));
+        block.push_back(static_cast<char>(flags));
+        appendPod(block, length);
+        block.insert(block.end(), value, value + length);
+        if (block.size() >= options.blockBytes) finishBlock();
+    }
+
+    uint64_t fileBytes() const { return offset + out.size() + block.size(); }
+
+    TablePtr finish() {
+        finishBlock();
+
+        // 过滤器按文件中的实际key数分配
+        std::vector<char> meta;
+        BloomFilter filter;
+        if (!keys.empty()) {
+            filter = BloomFilter(keys.size(), options.filterBitsPerKey);
+            for (int key : keys) filter.add(key);
+            meta.insert(meta.end(), filter.data(), filter.data() + filter.blockCount() * sizeof(BloomFilter::Block));
+        }
+        TableFooter footer;
+        std::memset(&footer, 0, sizeof(footer));
+        std::memcpy(footer.magic, kTableMagic, sizeof(kTableMagic));
+        footer.filterOffset = fileBytes();
+        footer.filterBlocks = filter.blockCount();
+        footer.filterKeys = filter.capacity();
+        footer.indexOffset = footer.filterOffset + meta.size();
+        footer.indexCount = index.size();
+        footer.entries = entries;
+        footer.smallest = smallest;
+        footer.largest = largest;
+        for (const BlockHandle& h : index) appendPod(meta, h);
+        uint32_t crc = crc32c::value(meta.data(), meta.size());
+        footer.crc = crc32c::extend(crc, reinterpret_cast<const char*>(&footer), offsetof(TableFooter, crc));
+        appendPod(meta, footer);
+        out.insert(out.end(), meta.begin(), meta.end());
+        flushOut();
+
+        if (fsync(fd) != 0) throw std::runtime_error("刷盘表文件失败: " + path);
+        close(fd);
+        fd = -1;
+        // 重新打开读入索引和过滤器，同时校验刚写出的文件
+        return std::make_shared<Table>(id, path);
+    }
+
+private:
+    void finishBlock() {
+        if (block.empty()) return;
+        int32_t lastKey = largest;
+        uint32_t crc = crc32c::value(block.data(), block.size());
+        appendPod(block, crc);
+        index.push_back(BlockHandle{lastKey, static_cast<uint32_t>(block.size()), fileBytes() - block.size()});
+        out.insert(out.end(), block.begin(), block.end());
+        block.clear();
+        if (out.size() >= kWriteBuffer) flushOut();
+    }
+
+    void flushOut() {
+        writeFully(fd, out.data(), out.size(), path);
+        offset += out.size();
+        out.clear();
+    }
+
+    uint64_t id;
+    std::string path;
+    const Options& options;
+    int fd;
+    uint64_t offset;             // 已写到文件的字节
+    std::vector<char> out;       // 待写出的完整数据块
+    std::vector<char> block;     // 正在填充的数据块
+    std::vector<BlockHandle> index;
+    std::vector<int> keys;
+    int smallest;
+    int largest;
+    uint64_t entries;
+};
+
+LSMStore::Table::Table(uint64_t id, const std::string& path)
+    : id(id), path(path), fd(-1), bytes(0), entries(0), smallest(0), largest(0), obsolete(false) {
+    fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) throw std::runtime_error("无法打开表文件: " + path);
+    try {
+        struct stat st;
+        if (fstat(fd, &st) != 0 || static_cast<uint64_t>(st.st_size) < sizeof(TableFooter)) {
+            throw std::runtime_error("表文件损坏: " + path);
+        }
+        bytes = static_cast<uint64_t>(st.st_size);
+        TableFooter footer;
+        readAt(fd, &footer, sizeof(footer), bytes - sizeof(footer), path);
+        uint64_t filterBytes = footer.filterBlocks * sizeof(BloomFilter::Block);
+        uint64_t indexBytes = footer.indexCount * sizeof(BlockHandle);
+        if (std::memcmp(footer.magic, kTableMagic, sizeof(kTableMagic)) != 0
+            || footer.filterOffset + filterBytes != footer.indexOffset
+            || footer.indexOffset + indexBytes != bytes - sizeof(footer)) {
+            throw std::runtime_error("表文件损坏: " + path);
+        }
+        std::vector<char> meta(filterBytes + indexBytes);
+        readAt(fd, meta.data(), meta.size(), footer.filterOffset, path);
+        uint32_t crc = crc32c::value(meta.data(), meta.size());
+        crc = crc32c::extend(crc, reinterpret_cast<const char*>(&footer), offsetof(TableFooter, crc));
+        if (crc != footer.crc) throw std::runtime_error("表文件损坏: " + path);
+
+        if (footer.filterBlocks > 0) {
+            filter = BloomFilter::fromBlocks(footer.filterKeys, meta.data(), footer.filterBlocks);
+        }
+        index.resize(footer.indexCount);
+        if (indexBytes > 0) std::memcpy(index.data(), meta.data() + filterBytes, indexBytes);
+        entries = footer.entries;
+        smallest = footer.smallest;
+        largest = footer.largest;
+    } catch (...) {
+        close(fd);
+        throw;
+    }
+}
+
+LSMStore::Table::~Table() {
+    close(fd);
+    if (obsolete) unlink(path.c_str());
+}
+
+void LSMStore::Table::readBlock(int readFd, const BlockHandle& handle, std::vector<char>& block) const {
+    if (handle.size < sizeof(uint32_t)) throw std::runtime_error("表文件损坏: " + path);
+    block.resize(handle.size);
+    readAt(readFd, block.data(), block.size(), handle.offset, path);
+    uint32_t crc;
+    size_t body = block.size() - sizeof(crc);
+    std::memcpy(&crc, block.data() + body, sizeof(crc));
+    if (crc != crc32c::value(block.data(), body)) throw std::runtime_error("表文件损坏: " + path);
+}
+
+LSMStore::Table::Lookup LSMStore::Table::get(int key, std::vector<char>& value) const {
+    if (key < smallest || key > largest || !filter.mayContain(key)) return Missing;
+    auto it = std::lower_bound(index.begin(), index.end(), key,
+                               [](const BlockHandle& h, int k) { return h.lastKey < k; });
+    if (it == index.end()) return Missing;
+    std::vector<char> block;
+    readBlock(fd, *it, block);
+    // 块内记录很少，顺序查找
+    size_t end = block.size() - sizeof(uint32_t);
+    size_t pos = 0;
+    while (pos + kEntryHeader <= end) {
+        const char* p = block.data() + pos;
+        int32_t k;
+        uint32_t length;
+        std::memcpy(&k, p, sizeof(k));
+        std::memcpy(&length, p + sizeof(int32_t) + sizeof(uint8_t), sizeof(length));
+        if (length > end - pos - kEntryHeader) throw std::runtime_error("表文件损坏: " + path);
+        if (k == key) {
+            if (static_cast<uint8_t>(p[sizeof(int32_t)]) != datalog::FLAG_PUT) return Deleted;
+            value.assign(p + kEntryHeader, p + kEntryHeader + length);
+            return Found;
+        }
+        if (k > key) break;
+        pos += kEntryHeader + length;
+    }
+    return Missing;
+}
+
+std::string LSMStore::filePath(const std::string& filename, uint64_t id, const char* suffix) {
+    char name[32];
+    std::snprintf(name, sizeof(name), ".%06llu%s", static_cast<unsigned long long>(id), suffix);
+    return filename + name;
+}
+
+std::vector<std::string> LSMStore::storageFiles(const std::string& filename) {
+    std::vector<std::string> files;
+    for (const auto& kv : listFiles(filename, ".sst")) files.push_back(kv.second);
+    for (const auto& kv : listFiles(filename, ".wal")) files.push_back(kv.second);
+    if (access((filename + ".manifest").c_str(), F_OK) == 0) files.push_back(filename + ".manifest");
+    return files;
+}
+
+void LSMStore::destroy(const std::string& filename) {
+    for (const auto& path : storageFiles(filename)) unlink(path.c_str());
+    unlink((filename + ".manifest.tmp").c_str());
+}
+
+LSMStore::LSMStore(const std::string& filename, const Options& options)
+    : options(options), dataPath(filename), logFd(-1), logNumber(0), nextFile(1), stopping(false), idle(false),
+      compactPointer(kLevels, INT64_MIN), userBytes(0), walBytes(0), flushBytes(0), compactionBytes(0),
+      compactions(0) {
+    recover();
+    background = std::thread(&LSMStore::backgroundLoop, this);
+}
+
+LSMStore::~LSMStore() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    workCv.notify_all();
+    if (background.joinable()) background.join();
+    if (logFd >= 0) {
+        fdatasync(logFd);
+        close(logFd);
+    }
+}
+
+void LSMStore::recover() {
+    // 构造期间没有并发访问，不加锁
+    auto version = std::make_shared<Version>();
+    std::set<uint64_t> live;
+    uint64_t savedNext = 1;
+    std::string manifestPath = dataPath + ".manifest";
+    int fd = open(manifestPath.c_str(), O_RDONLY);
+    if (fd >= 0) {
+        std::vector<char> buf;
+        char chunk[64 << 10];
+        ssize_t n;
+        while ((n = ::read(fd, chunk, sizeof(chunk))) > 0) buf.insert(buf.end(), chunk, chunk + n);
+        close(fd);
+
+        ManifestHeader header;
+        uint32_t crc = 0;
+        if (buf.size() < sizeof(header) + sizeof(crc)) throw std::runtime_error("manifest损坏: " + manifestPath);
+        std::memcpy(&header, buf.data(), sizeof(header));
+        std::memcpy(&crc, buf.data() + buf.size() - sizeof(crc), sizeof(crc));
+        if (std::memcmp(header.magic, kManifestMagic, sizeof(kManifestMagic)) != 0 || header.version != kManifestVersion
+            || header.levels != kLevels || crc != crc32c::value(buf.data(), buf.size() - sizeof(crc))) {
+            throw std::runtime_error("manifest损坏: " + manifestPath);
+        }
+        size_t pos = sizeof(header);
+        size_t limit = buf.size() - sizeof(crc);
+        for (size_t level = 0; level < kLevels; ++level) {
+            uint64_t count;
+            if (pos + sizeof(count) > limit) throw std::runtime_error("manifest损坏: " + manifestPath);
+            std::memcpy(&count, buf.data() + pos, sizeof(count));
+            pos += sizeof(count);
+            if (count > (limit - pos) / sizeof(uint64_t)) throw std::runtime_error("manifest损坏: " + manifestPath);
+            for (uint64_t i = 0; i < count; ++i) {
+                uint64_t id;
+                std::memcpy(&id, buf.data() + pos, sizeof(id));
+                pos += sizeof(id);
+                version->levels[level].push_back(std::make_shared<Table>(id, filePath(dataPath, id, ".sst")));
+                live.insert(id);
+            }
+        }
+        savedNext = header.nextFile;
+        logNumber = header.logNumber;
+    }
+
+    // 不在manifest中的表文件是写出或合并到一半的，删除；文件号从已有的最大号之后继续
+    uint64_t maxId = 0;
+    for (const auto& kv : listFiles(dataPath, ".sst")) {
+        maxId = std::max(maxId, kv.first);
+        if (live.count(kv.first) == 0) unlink(kv.second.c_str());
+    }
+    std::map<uint64_t, std::string> logs = listFiles(dataPath, ".wal");
+    for (const auto& kv : logs) maxId = std::max(maxId, kv.first);
+    nextFile = std::max(savedNext, maxId + 1);
+
+    // 按顺序回放还没写成表文件的WAL，残缺的尾部在记录校验处停止
+    MemTable replay;
+    for (const auto& kv : logs) {
+        if (kv.first < logNumber) continue;
+        datalog::LogScanner scanner(kv.second);
+        scanner.scan(0, [&replay](const datalog::RecordHeader& header, uint64_t, const char* value) {
+            MemEntry& e = replay.entries[header.key];
+            e.flags = header.flags;
+            e.value.assign(value, value + header.length);
+        });
+    }
+
+    // 回放的内容直接写成L0文件，之后旧的WAL都不再需要
+    TablePtr table = writeTable(replay);
+    if (table) {
+        flushBytes += table->bytes;
+        version->levels[0].insert(version->levels[0].begin(), table);
+    }
+    current = version;
+    openLog(nextFile++);
+    logNumber = mem.log;
+    saveManifest(*current, logNumber);
+    for (const auto& kv : logs) unlink(kv.second.c_str());
+}
+
+void LSMStore::openLog(uint64_t id) {
+    std::string path = filePath(dataPath, id, ".wal");
+    int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_APPEND, 0644);
+    if (fd < 0) throw std::runtime_error("无法创建WAL: " + path);
+    if (logFd >= 0) close(logFd);
+    logFd = fd;
+    mem.log = id;
+}
+
+void LSMStore::put(int key, const std::vector<char>& value) {
+    write(datalog::FLAG_PUT, key, value.data(), static_cast<uint32_t>(value.size()));
+}
+
+void LSMStore::del(int key) {
+    write(datalog::FLAG_TOMBSTONE, key, nullptr, 0);
+}
+
+void LSMStore::write(uint8_t flags, int key, const char* data, uint32_t size) {
+    datalog::RecordHeader header = datalog::makeHeader(flags, key, data, size);
+
+    std::unique_lock<std::mutex> lock(mutex);
+    if (!backgroundError.empty()) throw std::runtime_error("后台写出失败: " + backgroundError);
+    if (mem.bytes >= options.memtableBytes) {
+        // 上一张内存表还没写完时等待，内存中最多两张内存表
+        doneCv.wait(lock, [this]() { return !imm || !backgroundError.empty(); });
+        if (!backgroundError.empty()) throw std::runtime_error("后台写出失败: " + backgroundError);
+        switchMemtable();
+    }
+
+    struct iovec iov[2] = {{&header, sizeof(header)}, {const_cast<char*>(data), size}};
+    ssize_t expect = static_cast<ssize_t>(sizeof(header) + size);
+    if (writev(logFd, iov, size > 0 ? 2 : 1) != expect) {
+        throw std::runtime_error("写入WAL失败: " + filePath(dataPath, mem.log, ".wal"));
+    }
+    if (options.syncWrites) fdatasync(logFd);
+
+    auto r = mem.entries.emplace(key, MemEntry());
+    MemEntry& e = r.first->second;
+    if (r.second) {
+        mem.bytes += sizeof(int) + kMemEntryOverhead;
+    } else {
+        mem.bytes -= e.value.size();
+    }
+    e.flags = flags;
+    e.value.assign(data, data + size);
+    mem.bytes += size;
+    userBytes += sizeof(int) + size;
+    walBytes += static_cast<uint64_t>(expect);
+}
+
+void LSMStore::switchMemtable() {
+    std::shared_ptr<MemTable> table = std::make_shared<MemTable>();
+    std::swap(*table, mem);
+    openLog(nextFile++);
+    imm = table;
+    workCv.notify_one();
+}
+
+std::vector<char> LSMStore::get(int key) {
+    std::shared_ptr<const Version> v;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = mem.entries.find(key);
+        if (it != mem.entries.end()) {
+            return it->second.flags == datalog::FLAG_PUT ? it->second.value : std::vector<char>();
+        }
+        if (imm) {
+            auto old = imm->entries.find(key);
+            if (old != imm->entries.end()) {
+                return old->second.flags == datalog::FLAG_PUT ? old->second.value : std::vector<char>();
+            }
+        }
+        v = current;
+    }
+
+    std::vector<char> value;
+    for (const TablePtr& t : v->levels[0]) {
+        Table::Lookup r = t->get(key, value);
+        if (r != Table::Missing) return r == Table::Found ? value : std::vector<char>();
+    }
+    for (size_t level = 1; level < kLevels; ++level) {
+        // 每层最多一个文件的范围包含key：第一个largest不小于key的文件
+        const std::vector<TablePtr>& files = v->levels[level];
+        auto it = std::lower_bound(files.begin(), files.end(), key,
+                                   [](const TablePtr& t, int k) { return t->largest < k; });
+        if (it == files.end() || (*it)->smallest > key) continue;
+        Table::Lookup r = (*it)->get(key, value);
+        if (r != Table::Missing) return r == Table::Found ? value : std::vector<char>();
+    }
+    return {};
+}
+
+void LSMStore::flush() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (fdatasync(logFd) != 0) throw std::runtime_error("刷盘WAL失败");
+}
+
+size_t LSMStore::size() const {
+    std::vector<std::unique_ptr<Source>> sources;
+    std::shared_ptr<const Version> v;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        sources.emplace_back(new MemSource(mem));
+        if (imm) sources.emplace_back(new MemSource(*imm));
+        v = current;
+    }
+    for (const TablePtr& t : v->levels[0]) sources.emplace_back(new TableSource(t));
+    for (size_t level = 1; level < kLevels; ++level) {
+        if (!v->levels[level].empty()) sources.emplace_back(new LevelSource(v->levels[level]));
+    }
+    size_t count = 0;
+    for (MergeIterator it(std::move(sources)); it.valid(); it.next()) {
+        count += it.top().flags() == datalog::FLAG_PUT;
+    }
+    return count;
+}
+
+void LSMStore::waitIdle() {
+    std::unique_lock<std::mutex> lock(mutex);
+    doneCv.wait(lock, [this]() { return (idle && !imm) || !backgroundError.empty(); });
+    if (!backgroundError.empty()) throw std::runtime_error("后台写出失败: " + backgroundError);
+}
+
+LSMStore::Stats LSMStore::stats() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    Stats s;
+    s.userBytes = userBytes;
+    s.walBytes = walBytes;
+    s.flushBytes = flushBytes;
+    s.compactionBytes = compactionBytes;
+    s.compactions = compactions;
+    for (size_t level = 0; level < kLevels; ++level) {
+        uint64_t bytes = 0;
+        for (const TablePtr& t : current->levels[level]) bytes += t->bytes;
+        s.levelFiles.push_back(current->levels[level].size());
+        s.levelBytes.push_back(bytes);
+    }
+    return s;
+}
+
+void LSMStore::backgroundLoop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (backgroundError.empty()) {
+        // 写出内存表优先，停止时也要写完，合并在停止时放弃
+        int level = -1;
+        if (!imm) {
+            if (!stopping) level = pickLevel(*current);
+            if (level < 0) {
+                if (stopping) break;
+                idle = true;
+                doneCv.notify_all();
+                workCv.wait(lock);
+                idle = false;
+                continue;
+            }
+        }
+        lock.unlock();
+        try {
+            if (level < 0) {
+                flushImmutable();
+            } else {
+                compactLevel(level);
+            }
+        } catch (const std::exception& e) {
+            std::cerr << "LSMStore background work failed: " << e.what() << std::endl;
+            lock.lock();
+            backgroundError = e.what();
+            break;
+        }
+        lock.lock();
+        doneCv.notify_all();
+    }
+    idle = true;
+    doneCv.notify_all();
+}
+
+LSMStore::TablePtr LSMStore::writeTable(const MemTable& table) {
+    if (table.entries.empty()) return nullptr;
+    uint64_t id = nextFile++;
+    TableWriter writer(id, filePath(dataPath, id, ".sst"), options);
+    for (const auto& kv : table.entries) {
+        const MemEntry& e = kv.second;
+        writer.add(kv.first, e.flags, e.value.data(), static_cast<uint32_t>(e.value.size()));
+    }
+    return writer.finish();
+}
+
+void LSMStore::flushImmutable() {
+    std::shared_ptr<const MemTable> table;
+    std::shared_ptr<const Version> base;
+    uint64_t liveLog;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        table = imm;
+        base = current;
+        liveLog = mem.log;
+    }
+    TablePtr t = writeTable(*table);
+    auto next = std::make_shared<Version>(*base);
+    if (t) next->levels[0].insert(next->levels[0].begin(), t);
+    // 新版本生效之后才释放imm，读者总能在其中之一找到这些key
+    installVersion(next, liveLog);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        imm.reset();
+        if (t) flushBytes += t->bytes;
+    }
+    unlink(filePath(dataPath, table->log, ".wal").c_str());
+}
+
+uint64_t LSMStore::levelMaxBytes(size_t level) const {
+    uint64_t bytes = options.levelBaseBytes;
+    for (size_t l = 1; l < level; ++l) bytes *= options.levelMultiplier;
+    return bytes;
+}
+
+int LSMStore::pickLevel(const Version& v) const {
+    // 得分最高且不小于1的层：L0按文件数，其余按总大小，最深一层不再向下合并
+    double best = 1.0;
+    int level = -1;
+    double score = static_cast<double>(v.levels[0].size()) / std::max<size_t>(options.l0CompactionTrigger, 1);
+    if (score >= best) {
+        best = score;
+        level = 0;
+    }
+    for (size_t l = 1; l + 1 < kLevels; ++l) {
+        uint64_t bytes = 0;
+        for (const TablePtr& t : v.levels[l]) bytes += t->bytes;
+        score = static_cast<double>(bytes) / levelMaxBytes(l);
+        if (score >= best) {
+            best = score;
+            level = static_cast<int>(l);
+        }
+    }
+    return level;
+}
+
+void LSMStore::compactLevel(int level) {
+    // 版本只由后台线程修改，base在本次合并期间就是当前版本
+    std::shared_ptr<const Version> base;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        base = current;
+    }
+    const std::vector<TablePtr>& files = base->levels[level];
+    if (files.empty()) return;
+
+    std::vector<TablePtr> inputs;
+    if (level == 0) {
+        inputs = files;
+    } else {
+        // 轮流选择：第一个smallest大于上次合并位置的文件，到末尾后从头开始
+        TablePtr pick = files.front();
+        for (const TablePtr& t : files) {
+            if (t->smallest > compactPointer[level]) {
+                pick = t;
+                break;
+            }
+        }
+        inputs.push_back(pick);
+    }
+    int lo = inputs.front()->smallest;
+    int hi = inputs.front()->largest;
+    for (const TablePtr& t : inputs) {
+        lo = std::min(lo, t->smallest);
+        hi = std::max(hi, t->largest);
+    }
+    auto overlaps = [lo, hi](const TablePtr& t) { return !(t->largest < lo || t->smallest > hi); };
+
+    size_t out = static_cast<size_t>(level) + 1;
+    std::vector<TablePtr> overlap;
+    for (const TablePtr& t : base->levels[out]) {
+        if (overlaps(t)) overlap.push_back(t);
+    }
+
+    std::vector<TablePtr> outputs;
+    bool moved = level > 0 && overlap.empty();
+    if (moved) {
+        // 与下一层没有重叠，文件直接移到下一层
+        outputs = inputs;
+    } else {
+        // 更深的层中没有这个范围的数据时，墓碑已经没有可以遮住的旧记录
+        // 范围要包含下一层参与合并的文件，它们的墓碑也会在这里处理
+        int first = lo;
+        int last = hi;
+        for (const TablePtr& t : overlap) {
+            first = std::min(first, t->smallest);
+            last = std::max(last, t->largest);
+        }
+        bool dropTombstones = true;
+        for (size_t l = out + 1; l < kLevels; ++l) {
+            for (const TablePtr& t : base->levels[l]) dropTombstones &= t->largest < first || t->smallest > last;
+        }
+
+        std::vector<std::unique_ptr<Source>> sources;
+        for (const TablePtr& t : inputs) sources.emplace_back(new TableSource(t));
+        if (!overlap.empty()) sources.emplace_back(new LevelSource(overlap));
+        std::unique_ptr<TableWriter> writer;
+        for (MergeIterator it(std::move(sources)); it.valid(); it.next()) {
+            const Source& s = it.top();
+            if (dropTombstones && s.flags() != datalog::FLAG_PUT) continue;
+            if (!writer) {
+                uint64_t id = nextFile++;
+                writer.reset(new TableWriter(id, filePath(dataPath, id, ".sst"), options));
+            }
+            writer->add(s.key(), s.flags(), s.value(), s.length());
+            if (writer->fileBytes() >= options.tableBytes) {
+                outputs.push_back(writer->finish());
+                writer.reset();
+            }
+        }
+        if (writer) outputs.push_back(writer->finish());
+    }
+
+    auto next = std::make_shared<Version>(*base);
+    auto removeAll = [](std::vector<TablePtr>& v, const std::vector<TablePtr>& gone) {
+        v.erase(std::remove_if(v.begin(), v.end(),
+                               [&gone](const TablePtr& t) {
+                                   return std::find(gone.begin(), gone.end(), t) != gone.end();
+                               }),
+                v.end());
+    };
+    removeAll(next->levels[level], inputs);
+    removeAll(next->levels[out], overlap);
+    std::vector<TablePtr>& target = next->levels[out];
+    target.insert(target.end(), outputs.begin(), outputs.end());
+    std::sort(target.begin(), target.end(), [](const TablePtr& a, const TablePtr& b) { return a->smallest < b->smallest; });
+    compactPointer[level] = hi;
+
+    installVersion(next, logNumber);
+    uint64_t written = 0;
+    if (!moved) {
+        for (const TablePtr& t : outputs) written += t->bytes;
+        for (const TablePtr& t : inputs) t->obsolete = true;
+        for (const TablePtr& t : overlap) t->obsolete = true;
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    compactionBytes += written;
+    ++compactions;
+}
+
+void LSMStore::installVersion(const std::shared_ptr<const Version>& next, uint64_t log) {
+    saveManifest(*next, log);
+    std::lock_guard<std::mutex> lock(mutex);
+    current = next;
+    logNumber = log;
+}
+
+void LSMStore::saveManifest(const Version& v, uint64_t log) {
+    std::vector<char> buf;
+    ManifestHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, kManifestMagic, sizeof(kManifestMagic));
+    header.version = kManifestVersion;
+    header.levels = kLevels;
+    header.nextFile = nextFile;
+    header.logNumber = log;
+    appendPod(buf, header);
+    for (size_t level = 0; level < kLevels; ++level) {
+        appendPod(buf, static_cast<uint64_t>(v.levels[level].size()));
+        for (const TablePtr& t : v.levels[level]) appendPod(buf, t->id);
+    }
+    appendPod(buf, crc32c::value(buf.data(), buf.size()));
+
+    std::string path = dataPath + ".manifest";
+    std::string tmpPath = path + ".tmp";
+    int fd = open(tmpPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) throw std::runtime_error("无法创建manifest: " + tmpPath);
+    try {
+        writeFully(fd, buf.data(), buf.size(), tmpPath);
+        if (fsync(fd) != 0) throw std::runtime_error("刷盘manifest失败: " + tmpPath);
+    } catch (...) {
+        close(fd);
+        throw;
+    }
+    close(fd);
+    if (std::rename(tmpPath.c_str(), path.c_str()) != 0) {
+        throw std::runtime_error("替换manifest失败: " + path);
+    }
+}
@@ -0,0 +1,210 @@
+#ifndef LSM_STORE_H
+#define LSM_STORE_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "BloomFilter.h"
+#include "StorageEngine.h"
+
+// 日志结构合并引擎：内存中不保存逐个key的位置，适合key数量超出内存的场景
+// - 写入追加到WAL(与ObjectStorage相同的记录格式，DataLog.h)并放入内存表，内存表写满后切换，
+//   由后台线程写成一个有序的不可变表文件 filename.NNNNNN.sst，写完后删除对应的WAL
+// - 表文件按key排序，切成约blockBytes的数据块，value直接存在块中；文件末尾是块索引和Bloom过滤器，
+//   打开时读入内存，每个文件只占每块16字节的索引和每个key约filterBitsPerKey位的过滤器
+// - 分层合并：L0的文件由内存表写出，key范围可能重叠；L0文件数达到l0CompactionTrigger时与L1中重叠的文件合并；
+//   L1及以下每层的文件key范围互不重叠，某层总大小超过上限时轮流取一个文件与下一层重叠的文件合并，
+//   与下一层没有重叠时直接移到下一层，不重写；更深的层没有重叠的文件时丢弃墓碑
+// - 各层的文件列表记录在 filename.manifest 中，每次写出或合并后整体重写(临时文件 + rename)
+//
+// 并发：mutex保护内存表和当前版本(各层文件列表)；读者在锁内查内存表并取得版本的引用，在锁外读表文件；
+// 写出和合并都在后台线程中进行，只有前一张内存表还没写完时写者才会等待
+class LSMStore : public StorageEngine {
+public:
+    struct Options {
+        size_t memtableBytes = 4 << 20;          // 内存表的大小上限，写满后切换
+        size_t blockBytes = 4096;                // 数据块大小
+        unsigned filterBitsPerKey = 10;          // 每个表文件的Bloom过滤器，0为关闭
+        size_t l0CompactionTrigger = 4;          // L0文件数达到该值时合并到L1
+        uint64_t levelBaseBytes = 32ull << 20;   // L1的大小上限
+        unsigned levelMultiplier = 10;           // 每下一层的大小上限是上一层的倍数
+        uint64_t tableBytes = 8ull << 20;        // 合并输出的单个文件大小
+        bool syncWrites = false;                 // 每次写入后刷盘WAL
+    };
+
+    // 写放大 = (walBytes + flushBytes + compactionBytes) / userBytes
+    struct Stats {
+        uint64_t userBytes;          // 写入的key和value字节
+        uint64_t walBytes;           // 写入WAL的字节
+        uint64_t flushBytes;         // 内存表写出的表文件字节
+        uint64_t compactionBytes;    // 合并写出的表文件字节
+        uint64_t compactions;        // 合并次数(含直接移动)
+        std::vector<size_t> levelFiles;
+        std::vector<uint64_t> levelBytes;
+    };
+
+    LSMStore(const std::string& filename, const Options& options);
+    explicit LSMStore(const std::string& filename) : LSMStore(filename, Options()) {}
+
+    // 等待正在写出的内存表，当前内存表留在WAL中，下次打开时回放
+    ~LSMStore() override;
+
+    LSMStore(const LSMStore&) = delete;
+    LSMStore& operator=(const LSMStore&) = delete;
+
+    void put(int key, const std::vector<char>& value) override;
+
+    // 依次查找内存表、L0(从新到旧)和各层，找到值或墓碑即停止
+    std::vector<char> get(int key) override;
+
+    // 写入墓碑，合并到最深一层时丢弃
+    void del(int key) override;
+
+    // 把WAL刷到磁盘
+    void flush() override;
+
+    // 需要合并遍历内存表和全部表文件，开销与数据量成正比
+    size_t size() const override;
+
+    const char* name() const override { return "LSMStore"; }
+
+    // 等待后台线程写出内存表并完成所有需要的合并
+    void waitIdle();
+
+    Stats stats() const;
+
+    // 存储占用的全部文件(表文件、WAL和manifest)
+    static std::vector<std::string> storageFiles(const std::string& filename);
+
+    // 删除存储的全部文件
+    static void destroy(const std::string& filename);
+
+private:
+    struct MemEntry {
+        uint8_t flags;               // datalog::FLAG_PUT / FLAG_TOMBSTONE
+        std::vector<char> value;
+    };
+
+    // 内存表和它的WAL
+    struct MemTable {
+        std::map<int, MemEntry> entries;
+        size_t bytes = 0;            // 估算的内存占用
+        uint64_t log = 0;            // WAL的文件号
+    };
+
+    // 数据块在表文件中的位置，lastKey是块中最大的key
+    struct BlockHandle {
+        int32_t lastKey;
+        uint32_t size;               // 含块末尾的CRC
+        uint64_t offset;
+    };
+
+    // 打开的表文件，块索引和过滤器常驻内存；被合并掉后在最后一个版本释放时删除文件
+    struct Table {
+        uint64_t id;
+        std::string path;
+        int fd;
+        uint64_t bytes;
+        uint64_t entries;
+        int smallest;
+        int largest;
+        std::vector<BlockHandle> index;
+        BloomFilter filter;
+        std::atomic<bool> obsolete;
+
+        Table(uint64_t id, const std::string& path);
+        ~Table();
+
+        enum Lookup { Missing, Found, Deleted };
+        Lookup get(int key, std::vector<char>& value) const;
+
+        // 读入一个数据块并校验
+        void readBlock(int readFd, const BlockHandle& handle, std::vector<char>& block) const;
+    };
+
+    using TablePtr = std::shared_ptr<Table>;
+
+    static const size_t kLevels = 7;
+
+    // 各层的文件列表，不可修改；L0按从新到旧排列，其余各层按key排列
+    struct Version {
+        std::vector<TablePtr> levels[kLevels];
+    };
+
+    class TableWriter;
+    class Source;
+    class MemSource;
+    class TableSource;
+    class LevelSource;
+    class MergeIterator;
+
+    static std::string filePath(const std::string& filename, uint64_t id, const char* suffix);
+
+    // 读取manifest和表文件，回放WAL，删除不再需要的文件
+    void recover();
+
+    void write(uint8_t flags, int key, const char* data, uint32_t size);
+
+    // 创建新的WAL并让内存表使用它
+    void openLog(uint64_t id);
+
+    // 把当前内存表移到imm交给后台线程写出，调用方持有mutex
+    void switchMemtable();
+
+    void backgroundLoop();
+
+    // 把内存表写成一个表文件，内存表为空时返回空
+    TablePtr writeTable(const MemTable& table);
+
+    // 写出imm并安装包含它的新版本，之后删除它的WAL
+    void flushImmutable();
+
+    // 选择需要合并的层，没有时返回-1
+    int pickLevel(const Version& v) const;
+
+    // 合并一次，调用方只能是后台线程
+    void compactLevel(int level);
+
+    // 写manifest后把next设为当前版本
+    void installVersion(const std::shared_ptr<const Version>& next, uint64_t logNumber);
+    void saveManifest(const Version& v, uint64_t logNumber);
+
+    uint64_t levelMaxBytes(size_t level) const;
+
+    Options options;
+    std::string dataPath;
+
+    mutable std::mutex mutex;
+    std::condition_variable workCv;     // 通知后台线程
+    std::condition_variable doneCv;     // 后台线程写完内存表或进入空闲时通知
+    MemTable mem;
+    std::shared_ptr<const MemTable> imm;         // 正在写出的内存表
+    std::shared_ptr<const Version> current;
+    int logFd;                                   // 当前内存表的WAL，受mutex保护
+    uint64_t logNumber;                          // manifest中记录的需要回放的最早WAL，只由后台线程修改
+    std::atomic<uint64_t> nextFile;
+    bool stopping;
+    bool idle;
+    std::string backgroundError;                 // 后台线程失败后写入报错
+
+    // 只由后台线程使用：每层下一次合并从大于该key的文件开始，轮流覆盖整层
+    std::vector<int64_t> compactPointer;
+
+    // 统计，受mutex保护
+    uint64_t userBytes;
+    uint64_t walBytes;
+    uint64_t flushBytes;
+    uint64_t compactionBytes;
+    uint64_t compactions;
+
+    std::thread background;
+};
+
+#endif // LSM_STORE_H
@@ -1,146 +1,46 @@
-#include <unordered_map>
-#include <vector>
-#include <string>
-#include <ctime>
 #include <iostream>
-#include <fstream>
-#include <cassert>
-#include <sstream>
-
-struct KVNode {
-    int key;              //ؼ͸Ϊint
-    long offset;          //ļеƫ
-    size_t length;        //
-    void* memory_address; //ڴַ
-    bool in_memory;       //Ƿڴ
-    std::time_t timestamp; //ʱ
-
-    KVNode(int key, long offset, size_t length, void* memory_address, bool in_memory, std::time_t timestamp)
-        : key(key), offset(offset), length(length), memory_address(memory_address), in_memory(in_memory), timestamp(timestamp) {}
-
-    KVNode() : key(0), offset(0), length(0), memory_address(nullptr), in_memory(false), timestamp(0) {}
-};
-
-class KVStore {
-
-private:
-    std::unordered_map<int, KVNode> HashMap;//ڵϣ
-    std::vector<std::string> keyBuffer;
-    std::vector<std::string> valueBuffer;
-    size_t bufferLimit; //С
-    std::ofstream diskFile;
-    std::string disk_filename;
-
-public:
-    KVStore(size_t buffer_limit, const std::string& disk_filename) : bufferLimit(buffer_limit), disk_filename(disk_filename) {
-        diskFile.open(disk_filename, std::ios::app | std::ios::binary);
-        if (!diskFile.is_open()) {
-            throw std::runtime_error("޷򿪴ļ");
-        }
-    }
-
-    ~KVStore() {
-        if (diskFile.is_open()) {
-            // flushBuffersToDisk();
-            diskFile.close();
-        }
-    }
+#include <string>
+#include <vector>
 
-    std::string serializeKey(int key) {
-        std::ostringstream oss;
-        oss.write(reinterpret_cast<const char*>(&key), sizeof(key));  // дkeyֵ
-        return oss.str();
-    }
+#include "KVStore.h"
 
-    int deserializeKey(const std::string& binaryData) {
-        int key;
-        std::istringstream iss(binaryData);
-        iss.read(reinterpret_cast<char*>(&key), sizeof(key));  // жȡݵkey
-        return key;
+static std::string toString(const std::vector<char>& value) {
+    return std::string(value.begin(), value.end());
 }
 
-    template<typename T>
-    std::string serializeValue(const T& value) {
-        std::ostringstream oss;
-        oss.write(reinterpret_cast<const char*>(&value), sizeof(T));  // дvalue
-        return oss.str();
-    }
-
-    template<typename T>
-    T deserializeValue(const std::string& binaryData) {
-        T value;
-        std::istringstream iss(binaryData);
-        iss.read(reinterpret_cast<char*>(&value), sizeof(T));  // жȡݵvalue
-        return value;
-    }
-
-
-    // bool write(const std::string& key, const std::string& value) {
-    //     keyBuffer.push_back(key);
-    //     valueBuffer.push_back(value);
-
-    //     if (keyBuffer.size() >= bufferLimit) {
-    //         flushBuffersToDisk();
-    //     }
-    //     return true;
-    // }
-
-    // void flushBuffersToDisk() {
-    //     long offset = diskFile.tellp();
-    //     for (size_t i = 0; i < keyBuffer.size(); ++i) {
-    //         const std::string& key = keyBuffer[i];
-    //         const std::string& value = valueBuffer[i];
-
-    //         diskFile.write(value.data(), value.size());
-    //         HashMap[key] = KVNode(key, offset, value.size(), nullptr, false, std::time(nullptr));
-    //         offset += value.size();
-
-    //         std::cout << "Flushed " << key << " to disk at offset " << offset << " with length " << value.size() << std::endl;
-    //     }
-    //     keyBuffer.clear();
-    //     valueBuffer.clear();
-    // }
-
-    std::string readFromDisk(long offset, size_t length) {
-        std::ifstream diskFileRead(disk_filename, std::ios::binary);
-        if (!diskFileRead.is_open()) {
-            throw std::runtime_error("޷򿪴ļжȡ");
-        }
-        diskFileRead.seekg(offset);
-        std::string value(length, '\0');
-        diskFileRead.read(&value[0], length);
-        diskFileRead.close();
-        std::cout << "Read value from disk at offset " << offset << " with length " << length << ": " << value << std::endl;
-        return value;
-    }
-
-    // std::string read(const std::string& key) {
-    //     if (HashMap.find(key) != HashMap.end()) {
-    //         KVNode& node = HashMap[key];
-    //         if (node.in_memory && node.memory_address != nullptr) {
-    //             return std::string(static_cast<char*>(node.memory_address), node.length);
-    //         } else {
-    //             return readFromDisk(node.offset, node.length);
-    //         }
-    //     }
-    //     return "";
-    // }
-
-    // bool remove(const std::string& key) {
-    //     return HashMap.erase(key) > 0;
-    // }
-};
-
+static std::vector<char> toValue(const std::string& s) {
+    return std::vector<char>(s.begin(), s.end());
+}
 
 int main() {
     KVStore kvStore(2, "disk_data.bin");
 
     std::cout << "Testing write operations..." << std::endl;
-
-    std::string value1 = "test";
-    std::string value = kvStore.serializeValue(value1);
-    std::cout << "value: " << kvStore.deserializeValue<std::string>(value) << std::endl;
-    // kvStore.write("key1", "value1");
+    kvStore.write(1, toValue("value1"));
+    std::cout << "buffered: " << kvStore.buffered() << ", read key 1 from memory: " << toString(kvStore.read(1)) << std::endl;
+
+    // 第二条写入填满缓冲区，两条记录一起落盘
+    kvStore.write(2, toValue("value2"));
+    std::cout << "buffered: " << kvStore.buffered() << ", read key 2 from disk: " << toString(kvStore.read(2)) << std::endl;
+
+    kvStore.write(1, toValue("value1-updated"));
+    kvStore.remove(2);
+    kvStore.flushBuffersToDisk();
+    std::cout << "key 1: " << toString(kvStore.read(1)) << ", key 2 exists: " << !kvStore.read(2).empty() << std::endl;
+
+    int number = 42;
+    kvStore.write(3, kvStore.serializeValue(number));
+    std::cout << "key 3: " << kvStore.deserializeValue<int>(kvStore.read(3)) << std::endl;
+    std::cout << "objects: " << kvStore.size() << std::endl;
+
+    // 覆盖已有的长字符串key，新的值超过打包位置的大小上限；写入用的key字符串随后销毁
+    BasicKVStore<std::string> stringStore(1, "disk_data_string.bin");
+    {
+        std::string key(40, 'k');
+        stringStore.write(key, toValue("small"));
+        stringStore.write(key, std::vector<char>(1 << 20, 'v'));
+    }
+    std::cout << "long key value bytes: " << stringStore.read(std::string(40, 'k')).size() << std::endl;
 
     return 0;
 }
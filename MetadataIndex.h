@@ -0,0 +1,81 @@
+#ifndef METADATA_INDEX_H
+#define METADATA_INDEX_H
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include "OrderedIndex.h"
+#include "PackedIndex.h"
+
+// ObjectStorage元数据分片的索引：默认是哈希索引(PackedIndex)，打开orderedIndex时换成B+树(OrderedIndex)
+// 两者接口相同，这里按打开时的选择转发；分支在整个生命周期内不变，预测总是正确
+class MetadataIndex {
+public:
+    MetadataIndex() : ordered(false) {}
+
+    // 只能在索引为空时调用
+    void setOrdered(bool value) { ordered = value; }
+    bool isOrdered() const { return ordered; }
+
+    void setOffsetBits(unsigned bits) { packed.setOffsetBits(bits); }
+
+    bool find(int key, Location& loc) const { return ordered ? tree.find(key, loc) : packed.find(key, loc); }
+    bool contains(int key) const { return ordered ? tree.contains(key) : packed.contains(key); }
+
+    void assign(int key, const Location& loc) {
+        if (ordered) {
+            tree.assign(key, loc);
+        } else {
+            packed.assign(key, loc);
+        }
+    }
+
+    bool erase(int key) { return ordered ? tree.erase(key) : packed.erase(key); }
+
+    // f(key, const Location&)，有序索引按key递增的顺序
+    template <typename F>
+    void forEach(F f) const {
+        if (ordered) {
+            tree.forEach(f);
+        } else {
+            packed.forEach(f);
+        }
+    }
+
+    // 把[from, end)中key最小的至多limit个位置按key的顺序追加到out，返回是否已取完整个范围
+    // 哈希索引没有顺序，只能遍历全部key，因此忽略limit，一次取出整个范围再排序
+    bool collect(int from, int end, size_t limit, std::vector<std::pair<int, Location>>& out) const {
+        if (ordered) {
+            size_t n = tree.scan(from, end, limit, [&out](int key, const Location& loc) {
+                out.emplace_back(key, loc);
+            });
+            return n < limit;
+        }
+        size_t first = out.size();
+        packed.forEach([&](int key, const Location& loc) {
+            if (key >= from && key < end) out.emplace_back(key, loc);
+        });
+        std::sort(out.begin() + first, out.end(),
+                  [](const std::pair<int, Location>& a, const std::pair<int, Location>& b) { return a.first < b.first; });
+        return true;
+    }
+
+    void reserve(size_t n) {
+        if (ordered) {
+            tree.reserve(n);
+        } else {
+            packed.reserve(n);
+        }
+    }
+
+    size_t size() const { return ordered ? tree.size() : packed.size(); }
+    size_t memoryBytes() const { return ordered ? tree.memoryBytes() : packed.memoryBytes(); }
+
+private:
+    bool ordered;
+    PackedIndex<int> packed;
+    OrderedIndex<int> tree;
+};
+
+#endif // METADATA_INDEX_H
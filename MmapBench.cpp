@@ -0,0 +1,73 @@
+#include "ObjectStorage.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fcntl.h>
+#include <random>
+#include <unistd.h>
+
+// mmap读取测试：比较pread模式和mmap模式在不同工作集大小下的随机读吞吐
+// 工作集按数据量的比例选取，同时给出工作集占物理内存的比例；每轮开始前丢弃页缓存
+// 缓存只设1MB，读取基本都走页缓存或磁盘
+// 用法: MmapBench [数据量MB] [对象大小] [每轮读取次数]
+
+static void dropPageCache(const std::string& path) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) return;
+    fdatasync(fd);
+    posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+    close(fd);
+}
+
+static const char* modeName(ObjectStorage::ReadMode mode) {
+    return mode == ObjectStorage::ReadMode::Mmap ? "mmap" : "pread";
+}
+
+int main(int argc, char* argv[]) {
+    uint64_t dataMB = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 512;
+    size_t valueSize = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 4096;
+    size_t reads = argc > 3 ? std::strtoull(argv[3], nullptr, 10) : 200000;
+    const std::string path = "mmap_bench.dat";
+    int keys = static_cast<int>((dataMB << 20) / valueSize);
+    double ramBytes = static_cast<double>(sysconf(_SC_PHYS_PAGES)) * sysconf(_SC_PAGE_SIZE);
+
+    ObjectStorage::destroy(path);
+    {
+        ObjectStorage storage(path, 1 << 20);
+        std::vector<char> value(valueSize, 'x');
+        for (int k = 0; k < keys; ++k) storage.put(k, value);
+    }
+    std::cout << "data: " << dataMB << " MB, " << keys << " keys, value size " << valueSize << std::endl;
+    std::cout << "ws_fraction ws/ram mode ops/s" << std::endl;
+
+    for (double fraction : {0.01, 0.1, 0.5, 1.0}) {
+        int workingSet = std::max(1, static_cast<int>(keys * fraction));
+        double wsRatio = workingSet * static_cast<double>(valueSize) / ramBytes;
+        for (auto mode : {ObjectStorage::ReadMode::Pread, ObjectStorage::ReadMode::Mmap}) {
+            for (const auto& file : ObjectStorage::storageFiles(path)) dropPageCache(file);
+
+            ObjectStorage::Options options;
+            options.cacheBytes = 1 << 20;
+            options.backgroundCompaction = false;
+            options.readMode = mode;
+            ObjectStorage storage(path, options);
+
+            std::mt19937 rng(3);
+            std::uniform_int_distribution<int> dist(0, workingSet - 1);
+            uint64_t checksum = 0;
+            auto start = std::chrono::steady_clock::now();
+            for (size_t i = 0; i < reads; ++i) {
+                ValueRef value = storage.getRef(dist(rng));
+                // 读取首尾字节，确保mmap模式真正触发缺页
+                checksum += static_cast<unsigned char>(value.data()[0]) + value.data()[value.size() - 1];
+            }
+            double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            std::cout << fraction << " " << wsRatio << " " << modeName(mode) << " " << reads / sec
+                      << (checksum == 0 ? " (empty)" : "") << std::endl;
+        }
+    }
+
+    ObjectStorage::destroy(path);
+    return 0;
+}
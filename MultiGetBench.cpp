@@ -0,0 +1,82 @@
+#include "ObjectStorage.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <random>
+
+// 批量接口测试：批大小从1到1024，比较multiGet/multiPut和逐个调用get/put的吞吐
+// 读取分两种模式：random为随机key，clustered为从随机起点开始的连续key(在日志中相邻，可以合并读取)
+// 缓存只设1MB，读取基本都未命中缓存
+// 用法: MultiGetBench [对象数量] [对象大小] [每轮操作数]
+
+static double seconds(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char* argv[]) {
+    int keys = argc > 1 ? std::atoi(argv[1]) : 200000;
+    size_t valueSize = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 100;
+    size_t ops = argc > 3 ? std::strtoull(argv[3], nullptr, 10) : 200000;
+    const std::string path = "multiget_bench.dat";
+
+    ObjectStorage::Options options;
+    options.cacheBytes = 1 << 20;
+    options.backgroundCompaction = false;
+    ValueRef value = ValueRef::copyOf(std::vector<char>(valueSize, 'x').data(), valueSize);
+
+    std::cout << "op batch loop_ops/s multi_ops/s" << std::endl;
+    for (size_t batch : {1, 4, 16, 64, 256, 1024}) {
+        ObjectStorage::destroy(path);
+        ObjectStorage storage(path, options);
+        std::vector<std::pair<int, ValueRef>> items;
+
+        auto start = std::chrono::steady_clock::now();
+        for (int k = 0; k < keys; ++k) storage.put(k, value);
+        double loop = keys / seconds(start);
+
+        start = std::chrono::steady_clock::now();
+        for (int k = 0; k < keys;) {
+            items.clear();
+            for (size_t i = 0; i < batch && k < keys; ++i, ++k) items.emplace_back(k, value);
+            storage.multiPut(items);
+        }
+        double multi = keys / seconds(start);
+        std::cout << "put " << batch << " " << loop << " " << multi << std::endl;
+    }
+
+    for (bool clustered : {false, true}) {
+        for (size_t batch : {1, 4, 16, 64, 256, 1024}) {
+            ObjectStorage storage(path, options);
+            std::mt19937 rng(7);
+            std::uniform_int_distribution<int> dist(0, keys - 1);
+            std::vector<int> request(batch);
+            auto fill = [&]() {
+                int base = dist(rng);
+                for (size_t i = 0; i < batch; ++i) {
+                    request[i] = clustered ? static_cast<int>((base + i) % keys) : dist(rng);
+                }
+            };
+
+            size_t rounds = ops / batch;
+            size_t found = 0;
+            auto start = std::chrono::steady_clock::now();
+            for (size_t r = 0; r < rounds; ++r) {
+                fill();
+                for (int key : request) found += !storage.getRef(key).empty();
+            }
+            double loop = rounds * batch / seconds(start);
+
+            start = std::chrono::steady_clock::now();
+            for (size_t r = 0; r < rounds; ++r) {
+                fill();
+                for (const ValueRef& v : storage.multiGet(request)) found += !v.empty();
+            }
+            double multi = rounds * batch / seconds(start);
+            std::cout << (clustered ? "get_clustered " : "get_random ") << batch << " " << loop << " " << multi
+                      << (found != 2 * rounds * batch ? " (missing)" : "") << std::endl;
+        }
+    }
+
+    ObjectStorage::destroy(path);
+    return 0;
+}
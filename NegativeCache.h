@@ -0,0 +1,66 @@
+#ifndef NEGATIVE_CACHE_H
+#define NEGATIVE_CACHE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "FlatHashMap.h"
+
+// 负查找缓存：记住最近查过但不存在(或刚被删除)的key，命中时不查元数据也不读盘
+// 直接映射的定长数组，每个槽是一个原子变量，新key覆盖同一位置上的旧key，不分配内存也不加锁
+// 一致性由调用方保证：插入在该key的元数据分片锁内进行，写入该key时在独占锁内清除，
+// 因此"不存在"的结论不会晚于元数据的更新
+class NegativeCache {
+public:
+    struct Stats {
+        size_t slots;       // 槽数，0为关闭
+        uint64_t hits;      // 查到"不存在"的次数
+    };
+
+    // slots向上取整到2的幂，0为关闭
+    explicit NegativeCache(size_t slots) : mask(0), hitCount(0) {
+        if (slots == 0) return;
+        size_t n = 1;
+        while (n < slots) n *= 2;
+        table = std::vector<std::atomic<uint64_t>>(n);
+        mask = n - 1;
+    }
+
+    NegativeCache(const NegativeCache&) = delete;
+    NegativeCache& operator=(const NegativeCache&) = delete;
+
+    bool contains(int key) {
+        if (table.empty()) return false;
+        if (slotOf(key).load(std::memory_order_acquire) != tag(key)) return false;
+        hitCount.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    void insert(int key) {
+        if (table.empty()) return;
+        slotOf(key).store(tag(key), std::memory_order_release);
+    }
+
+    // 只清除仍是该key的槽，其他key在此期间覆盖的槽保持不变
+    void erase(int key) {
+        if (table.empty()) return;
+        uint64_t expected = tag(key);
+        slotOf(key).compare_exchange_strong(expected, 0, std::memory_order_acq_rel);
+    }
+
+    Stats stats() const { return {table.size(), hitCount.load(std::memory_order_relaxed)}; }
+
+private:
+    // 空槽为0，有效的槽带上第32位，key为0时也不会与空槽混淆
+    static uint64_t tag(int key) { return static_cast<uint32_t>(key) | (1ull << 32); }
+
+    std::atomic<uint64_t>& slotOf(int key) { return table[FlatHash()(key) & mask]; }
+
+    std::vector<std::atomic<uint64_t>> table;
+    size_t mask;
+    std::atomic<uint64_t> hitCount;
+};
+
+#endif // NEGATIVE_CACHE_H
@@ -0,0 +1,1513 @@
+#include "ObjectStorage.h"
+
+#include <cstring>
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <climits>
+#include <unordered_map>
+#include <cstdio>
+#include <functional>
+#include <queue>
+#include <stdexcept>
+
+#include "DataLog.h"
+#include "RateLimiter.h"
+
+ObjectStorage::Segment::Segment(uint32_t id, const std::string& path, bool direct)
+    : id(id), path(path), bytes(0), liveBytes(0) {
+    fd = open(path.c_str(), O_RDONLY | (direct ? O_DIRECT : 0));
+    if (fd < 0) {
+        throw std::runtime_error(std::string(direct && errno == EINVAL ? "文件系统不支持O_DIRECT: "
+                                                                        : "无法打开数据文件: ") + path);
+    }
+    struct stat st;
+    if (fstat(fd, &st) == 0) bytes = static_cast<uint64_t>(st.st_size);
+}
+
+ObjectStorage::Segment::~Segment() {
+    close(fd);
+}
+
+ObjectStorage::Mapping::~Mapping() {
+    munmap(const_cast<char*>(addr), len);
+}
+
+std::string ObjectStorage::segmentPath(const std::string& filename, uint32_t id) {
+    char suffix[16];
+    std::snprintf(suffix, sizeof(suffix), ".%06u", id);
+    return filename + suffix;
+}
+
+std::map<uint32_t, std::string> ObjectStorage::listSegments(const std::string& filename) {
+    std::string dir = ".";
+    std::string base = filename;
+    size_t slash = filename.rfind('/');
+    if (slash != std::string::npos) {
+        dir = slash == 0 ? "/" : filename.substr(0, slash);
+        base = filename.substr(slash + 1);
+    }
+    std::string prefix = base + ".";
+
+    std::map<uint32_t, std::string> found;
+    DIR* d = opendir(dir.c_str());
+    if (!d) return found;
+    while (struct dirent* ent = readdir(d)) {
+        std::string name = ent->d_name;
+        if (name.size() <= prefix.size() || name.compare(0, prefix.size(), prefix) != 0) continue;
+        std::string digits = name.substr(prefix.size());
+        if (digits.size() > 10 || !std::all_of(digits.begin(), digits.end(), ::isdigit)) continue;
+        uint32_t id = static_cast<uint32_t>(std::stoul(digits));
+        found[id] = segmentPath(filename, id);
+    }
+    closedir(d);
+    return found;
+}
+
+std::vector<std::string> ObjectStorage::storageFiles(const std::string& filename) {
+    std::vector<std::string> files;
+    for (const auto& kv : listSegments(filename)) files.push_back(kv.second);
+    if (access((filename + ".idx").c_str(), F_OK) == 0) files.push_back(filename + ".idx");
+    if (access((filename + ".filter").c_str(), F_OK) == 0) files.push_back(filename + ".filter");
+    return files;
+}
+
+void ObjectStorage::destroy(const std::string& filename) {
+    for (const auto& path : storageFiles(filename)) unlink(path.c_str());
+    unlink(filename.c_str());
+    unlink((filename + ".idx.tmp").c_str());
+    unlink((filename + ".filter.tmp").c_str());
+}
+
+// ObjectStorage 类实现
+ObjectStorage::ObjectStorage(const std::string& filename, size_t cacheBytes, CachePolicy cachePolicy)
+    : ObjectStorage(filename, [&]() {
+          Options o;
+          o.cacheBytes = cacheBytes;
+          o.cachePolicy = cachePolicy;
+          return o;
+      }()) {}
+
+ObjectStorage::ObjectStorage(const std::string& filename, const Options& options)
+    : options(options), dataPath(filename), writeFd(-1), directBuffers(kDirectBlock, 64 << 10, 64),
+      stageFill(0), compactions(0), writes(), dirty(false),
+      lastSync(std::chrono::steady_clock::now()), commitStopping(false),
+      index(filename + ".idx"), cache(options.cacheBytes, 0, options.cachePolicy),
+      negative(options.negativeCacheSlots), stopping(false) {
+    if (options.directIO && options.readMode == ReadMode::Mmap) {
+        throw std::invalid_argument("directIO不能与mmap读取模式同时使用");
+    }
+    // 偏移的位宽按段大小确定，段号占其余的位
+    unsigned offsetBits = PackedIndex<int>::offsetBitsFor(options.segmentBytes + sizeof(datalog::RecordHeader), 16);
+    for (MetadataShard& shard : metadataMap) {
+        shard.map.setOrdered(options.orderedIndex);
+        shard.map.setOffsetBits(offsetBits);
+    }
+    recover();
+
+    if (options.backgroundCompaction) {
+        compactionThread = std::thread(&ObjectStorage::compactionLoop, this);
+    }
+    if (options.syncPolicy == SyncPolicy::Interval) {
+        syncThread = std::thread(&ObjectStorage::syncLoop, this);
+    }
+}
+
+ObjectStorage::~ObjectStorage() {
+    {
+        std::lock_guard<std::mutex> lock(backgroundMutex);
+        stopping = true;
+    }
+    backgroundCv.notify_all();
+    if (compactionThread.joinable()) compactionThread.join();
+    if (syncThread.joinable()) syncThread.join();
+
+    // 先写完排队的异步写，再等待在途的异步读完成
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        commitStopping = true;
+    }
+    queueCv.notify_all();
+    if (commitThread.joinable()) commitThread.join();
+    io.reset();
+
+    if (writeFd >= 0) {
+        // 截掉O_DIRECT整块写入时补的零
+        if (options.directIO && ftruncate(writeFd, active->bytes) != 0) {
+            std::cerr << "无法截断数据文件: " << active->path << std::endl;
+        }
+        if (options.syncPolicy != SyncPolicy::None) fdatasync(writeFd);
+        close(writeFd);
+    }
+}
+
+uint64_t ObjectStorage::recordBytes(uint32_t size) {
+    return sizeof(datalog::RecordHeader) + size;
+}
+
+void ObjectStorage::rollSegment() {
+    // 封存前截掉补零部分并刷盘，之后封存段的内容不再变化
+    if (options.directIO && ftruncate(writeFd, active->bytes) != 0) {
+        throw std::runtime_error("无法截断数据文件: " + active->path);
+    }
+    fdatasync(writeFd);
+    close(writeFd);
+    writeFd = -1;
+
+    uint32_t id = active->id + 1;
+    std::string path = segmentPath(dataPath, id);
+    openActive(path, O_CREAT | O_TRUNC, 0);
+    std::shared_ptr<Segment> seg = std::make_shared<Segment>(id, path, options.directIO);
+    {
+        std::unique_lock<std::shared_mutex> lock(segmentsMutex);
+        segments[id] = seg;
+    }
+    active = seg;
+}
+
+void ObjectStorage::put(int key, const std::vector<char>& value) {
+    put(key, ValueRef::copyOf(value.data(), value.size()));
+}
+
+void ObjectStorage::put(int key, std::vector<char>&& value) {
+    put(key, ValueRef::fromVector(std::move(value)));
+}
+
+void ObjectStorage::put(int key, ValueRef value) {
+    WriteRequest req = {datalog::FLAG_PUT, key, std::move(value), false, nullptr, nullptr};
+    submit(&req, 1);
+}
+
+void ObjectStorage::multiPut(const std::vector<std::pair<int, ValueRef>>& items) {
+    std::vector<WriteRequest> reqs;
+    reqs.reserve(items.size());
+    for (const auto& item : items) {
+        reqs.push_back({datalog::FLAG_PUT, item.first, item.second, false, nullptr, nullptr});
+    }
+    submit(reqs.data(), reqs.size());
+}
+
+void ObjectStorage::submit(WriteRequest* reqs, size_t count) {
+    std::unique_lock<std::mutex> lock(queueMutex);
+    // 一次入队，同一调用的请求在队列中相邻
+    for (size_t i = 0; i < count; ++i) {
+        writeQueue.push_back(&reqs[i]);
+    }
+    // 等待前面的领导者把请求一起写出，或者轮到某个请求成为队首；全部完成后才返回
+    std::exception_ptr error;
+    for (size_t i = 0; i < count; ++i) {
+        WriteRequest& req = reqs[i];
+        queueCv.wait(lock, [&]() { return req.done || writeQueue.front() == &req; });
+        if (!req.done) lead(lock);
+        if (req.error && !error) error = req.error;
+    }
+    if (error) std::rethrow_exception(error);
+}
+
+void ObjectStorage::lead(std::unique_lock<std::mutex>& lock) {
+    // 取出队列前部不超过writeBatchBytes的请求作为一批
+    std::vector<WriteRequest*> batch;
+    uint64_t bytes = 0;
+    for (WriteRequest* r : writeQueue) {
+        uint64_t len = recordBytes(r->value.size());
+        if (!batch.empty() && bytes + len > options.writeBatchBytes) break;
+        batch.push_back(r);
+        bytes += len;
+    }
+    lock.unlock();
+
+    // 写出期间新来的写者继续排队，组成下一批
+    std::exception_ptr error;
+    try {
+        writeBatch(batch);
+    } catch (...) {
+        error = std::current_exception();
+    }
+
+    lock.lock();
+    std::vector<WriteRequest*> async;
+    for (WriteRequest* r : batch) {
+        writeQueue.pop_front();
+        if (r->onDone) {
+            async.push_back(r);
+        } else {
+            r->error = error;
+            r->done = true;
+        }
+    }
+    queueCv.notify_all();
+
+    // 异步请求的回调在锁外执行，回调中可以再次提交
+    if (!async.empty()) {
+        lock.unlock();
+        for (WriteRequest* r : async) {
+            r->onDone(error);
+            delete r;
+        }
+        lock.lock();
+    }
+}
+
+void ObjectStorage::commitLoop() {
+    std::unique_lock<std::mutex> lock(queueMutex);
+    while (true) {
+        // 队首是同步请求时由它自己带领，这里只处理没有线程等待的异步请求
+        queueCv.wait(lock, [this]() {
+            return commitStopping || (!writeQueue.empty() && writeQueue.front()->onDone);
+        });
+        if (!writeQueue.empty() && writeQueue.front()->onDone) {
+            lead(lock);
+        } else if (commitStopping) {
+            break;
+        }
+    }
+}
+
+void ObjectStorage::putAsync(int key, ValueRef value, PutCallback callback) {
+    std::call_once(commitOnce, [this]() { commitThread = std::thread(&ObjectStorage::commitLoop, this); });
+    WriteRequest* req = new WriteRequest{datalog::FLAG_PUT, key, std::move(value), false, nullptr, std::move(callback)};
+    std::lock_guard<std::mutex> lock(queueMutex);
+    writeQueue.push_back(req);
+    queueCv.notify_all();
+}
+
+std::future<void> ObjectStorage::putAsync(int key, ValueRef value) {
+    std::shared_ptr<std::promise<void>> promise = std::make_shared<std::promise<void>>();
+    std::future<void> result = promise->get_future();
+    putAsync(key, std::move(value), [promise](std::exception_ptr error) {
+        if (error) {
+            promise->set_exception(error);
+        } else {
+            promise->set_value();
+        }
+    });
+    return result;
+}
+
+void ObjectStorage::openActive(const std::string& path, int flags, uint64_t bytes) {
+    writeFd = open(path.c_str(), O_WRONLY | flags | (options.directIO ? O_DIRECT : 0), 0644);
+    if (writeFd < 0) {
+        throw std::runtime_error(std::string(options.directIO && errno == EINVAL ? "文件系统不支持O_DIRECT: "
+                                                                                : "无法打开数据文件: ") + path);
+    }
+    if (!options.directIO) return;
+
+    // 末块已写入的部分读回暂存区，下次写入时整块重写
+    if (!directStage.data()) directStage = directBuffers.acquire(kDirectStageBytes);
+    stageFill = static_cast<size_t>(bytes % kDirectBlock);
+    if (stageFill == 0) return;
+    int fd = open(path.c_str(), O_RDONLY);
+    ssize_t n = fd < 0 ? -1 : pread(fd, directStage.data(), stageFill, bytes - stageFill);
+    if (fd >= 0) close(fd);
+    if (n != static_cast<ssize_t>(stageFill)) {
+        throw std::runtime_error("读取数据文件失败: " + path);
+    }
+}
+
+void ObjectStorage::writeDirect(const std::vector<struct iovec>& iov, uint64_t offset) {
+    // 暂存区开头保存着末块已写入的部分，从末块起点开始整块写出
+    uint64_t block = offset - stageFill;
+    char* stage = directStage.data();
+    size_t fill = stageFill;
+    auto writeOut = [&](size_t len) {
+        if (pwrite(writeFd, stage, len, block) != static_cast<ssize_t>(len)) {
+            throw std::runtime_error("写入数据文件失败: " + active->path);
+        }
+    };
+    for (const struct iovec& v : iov) {
+        const char* src = static_cast<const char*>(v.iov_base);
+        size_t left = v.iov_len;
+        while (left > 0) {
+            size_t n = std::min(left, directStage.size() - fill);
+            std::memcpy(stage + fill, src, n);
+            fill += n;
+            src += n;
+            left -= n;
+            if (fill == directStage.size()) {
+                writeOut(fill);
+                block += fill;
+                fill = 0;
+            }
+        }
+    }
+    if (fill > 0) {
+        // 末尾补零到整块，未写满的末块移到暂存区开头，下次写入时一起重写
+        size_t padded = directBuffers.roundUp(fill);
+        std::memset(stage + fill, 0, padded - fill);
+        writeOut(padded);
+        size_t tail = fill % kDirectBlock;
+        std::memmove(stage, stage + fill - tail, tail);
+        fill = tail;
+    }
+    stageFill = fill;
+}
+
+void ObjectStorage::writeVectors(std::vector<struct iovec>& iov, uint64_t offset) {
+    if (options.directIO) {
+        writeDirect(iov, offset);
+        iov.clear();
+        return;
+    }
+    size_t i = 0;
+    while (i < iov.size()) {
+        int count = static_cast<int>(std::min<size_t>(IOV_MAX, iov.size() - i));
+        size_t expect = 0;
+        for (int k = 0; k < count; ++k) expect += iov[i + k].iov_len;
+        if (pwritev(writeFd, &iov[i], count, offset) != static_cast<ssize_t>(expect)) {
+            throw std::runtime_error("写入数据文件失败: " + active->path);
+        }
+        offset += expect;
+        i += count;
+    }
+    iov.clear();
+}
+
+void ObjectStorage::writeBatch(const std::vector<WriteRequest*>& batch) {
+    std::lock_guard<std::mutex> writeLock(writeMutex);
+
+    // 持有writeMutex时元数据不会变化，可以不加分片锁读取
+    // 删除不存在的key不写记录，同一批中先写后删按批内顺序判断
+    std::unordered_map<int, bool> batchLive;
+    auto isLive = [&](int key) {
+        auto it = batchLive.find(key);
+        if (it != batchLive.end()) return it->second;
+        const MetadataShard& shard = metadataShard(key);
+        return shard.map.contains(key);
+    };
+
+    std::vector<datalog::RecordHeader> headers(batch.size());
+    std::vector<Location> entries(batch.size());
+    std::vector<bool> skipped(batch.size(), false);
+    std::vector<struct iovec> iov;
+    iov.reserve(batch.size() * 2);
+    std::vector<IndexFile::Record> records;
+    records.reserve(batch.size());
+
+    uint64_t start = active->bytes;
+    uint64_t pos = start;
+    for (size_t i = 0; i < batch.size(); ++i) {
+        WriteRequest& r = *batch[i];
+        if (r.flags == datalog::FLAG_TOMBSTONE && !isLive(r.key)) {
+            skipped[i] = true;
+            continue;
+        }
+        batchLive[r.key] = r.flags == datalog::FLAG_PUT;
+
+        uint32_t size = r.value.size();
+        uint64_t total = recordBytes(size);
+        if (pos > 0 && pos + total > options.segmentBytes) {
+            // 活动段放不下，先写出已攒的部分再切换到新段
+            writeVectors(iov, start);
+            active->bytes = pos;
+            rollSegment();
+            start = pos = active->bytes;
+        }
+
+        headers[i] = datalog::makeHeader(r.flags, r.key, r.value.data(), size);
+        iov.push_back({&headers[i], sizeof(datalog::RecordHeader)});
+        if (size > 0) iov.push_back({const_cast<char*>(r.value.data()), size});
+        entries[i] = {active->id, pos + sizeof(datalog::RecordHeader), size};
+        pos += total;
+
+        IndexFile::Record rec;
+        std::memset(&rec, 0, sizeof(rec));
+        rec.op = r.flags == datalog::FLAG_PUT ? IndexFile::OP_PUT : IndexFile::OP_DEL;
+        rec.key = r.key;
+        rec.size = size;
+        rec.segment = entries[i].segment;
+        rec.offset = entries[i].offset;
+        records.push_back(rec);
+    }
+    // 数据先落到文件，再写索引记录，保证索引不会指向不存在的数据
+    writeVectors(iov, start);
+    active->bytes = pos;
+    index.append(records);
+    syncAfterBatch();
+    ++writes.batches;
+    writes.records += records.size();
+
+    // 元数据和缓存在同一把分片锁内更新，读者回填缓存时据此判断数据是否过期
+    // 按元数据分片分组，每个分片只加一次锁；同一key在同一组内，批内顺序不变
+    std::vector<uint32_t> shardOf(batch.size());
+    for (size_t i = 0; i < batch.size(); ++i) shardOf[i] = metadataShardIndex(batch[i]->key);
+    std::vector<uint32_t> order;
+    orderByShard(shardOf, kMetadataShards, order);
+    std::vector<std::pair<int, ValueRef>> cached;
+    size_t g = 0;
+    while (g < order.size()) {
+        uint32_t s = shardOf[order[g]];
+        MetadataShard& shard = metadataMap[s];
+        std::unique_lock<std::shared_mutex> lock(shard.mutex);
+        cached.clear();
+        for (; g < order.size() && shardOf[order[g]] == s; ++g) {
+            size_t i = order[g];
+            WriteRequest& r = *batch[i];
+            if (skipped[i]) {
+                negative.insert(r.key);
+                cached.emplace_back(r.key, ValueRef());
+                continue;
+            }
+            Location old;
+            if (shard.map.find(r.key, old)) {
+                // 旧记录成为所在段的垃圾
+                segments.at(old.segment)->liveBytes -= recordBytes(old.size);
+            }
+            if (r.flags == datalog::FLAG_PUT) {
+                shard.map.assign(r.key, entries[i]);
+                filterAdd(shard, r.key);
+                negative.erase(r.key);
+                segments.at(entries[i].segment)->liveBytes += recordBytes(entries[i].size);
+                cached.emplace_back(r.key, std::move(r.value));
+            } else {
+                // 墓碑记录本身不算存活数据；空句柄让缓存释放该key的条目
+                shard.map.erase(r.key);
+                negative.insert(r.key);
+                cached.emplace_back(r.key, ValueRef());
+            }
+        }
+        cache.putMany(cached);
+    }
+}
+
+void ObjectStorage::syncAfterBatch() {
+    if (options.syncPolicy == SyncPolicy::EveryBatch) {
+        fdatasync(writeFd);
+        ++writes.syncs;
+        return;
+    }
+    if (options.syncPolicy == SyncPolicy::Interval) {
+        dirty = true;
+        auto now = std::chrono::steady_clock::now();
+        if (now - lastSync >= std::chrono::milliseconds(options.syncIntervalMs)) {
+            fdatasync(writeFd);
+            ++writes.syncs;
+            lastSync = now;
+            dirty = false;
+        }
+    }
+}
+
+void ObjectStorage::syncLoop() {
+    // 写入停止后，最后一批数据也会在一个间隔内刷盘
+    std::unique_lock<std::mutex> lock(backgroundMutex);
+    while (!stopping) {
+        backgroundCv.wait_for(lock, std::chrono::milliseconds(options.syncIntervalMs));
+        if (stopping) break;
+        lock.unlock();
+        {
+            std::lock_guard<std::mutex> writeLock(writeMutex);
+            if (dirty) {
+                fdatasync(writeFd);
+                ++writes.syncs;
+                lastSync = std::chrono::steady_clock::now();
+                dirty = false;
+            }
+        }
+        lock.lock();
+    }
+}
+
+void ObjectStorage::flush() {
+    std::lock_guard<std::mutex> writeLock(writeMutex);
+    fdatasync(writeFd);
+    ++writes.syncs;
+    lastSync = std::chrono::steady_clock::now();
+    dirty = false;
+}
+
+ObjectStorage::WriteStats ObjectStorage::writeStats() {
+    std::lock_guard<std::mutex> writeLock(writeMutex);
+    return writes;
+}
+
+std::vector<char> ObjectStorage::get(int key) {
+    return getRef(key).toVector();
+}
+
+std::shared_ptr<ObjectStorage::Segment> ObjectStorage::findSegment(uint32_t id) {
+    std::shared_lock<std::shared_mutex> lock(segmentsMutex);
+    auto it = segments.find(id);
+    return it != segments.end() ? it->second : nullptr;
+}
+
+std::shared_ptr<const ObjectStorage::Mapping> ObjectStorage::mapSegment(Segment& seg, uint64_t end) {
+    std::shared_ptr<const Mapping> current = std::atomic_load(&seg.mapping);
+    if (current && current->len >= end) return current;
+
+    std::lock_guard<std::mutex> lock(seg.mapMutex);
+    current = std::atomic_load(&seg.mapping);
+    if (current && current->len >= end) return current;
+
+    // 至少预留一个段的长度，活动段在预留范围内增长时共享映射直接可见新数据，不需要重新映射；
+    // 只会访问已写入的部分，预留的文件末尾之后的页不会被触碰
+    size_t len = static_cast<size_t>(std::max<uint64_t>(end, options.segmentBytes));
+    void* addr = mmap(nullptr, len, PROT_READ, MAP_SHARED, seg.fd, 0);
+    if (addr == MAP_FAILED) {
+        throw std::runtime_error("无法映射数据文件: " + seg.path);
+    }
+    int advice = MADV_NORMAL;
+    if (options.mmapAdvice == MmapAdvice::Random) advice = MADV_RANDOM;
+    if (options.mmapAdvice == MmapAdvice::Sequential) advice = MADV_SEQUENTIAL;
+    madvise(addr, len, advice);
+
+    // 旧映射由仍在使用的ValueRef持有，释放后自动解除
+    std::shared_ptr<const Mapping> mapping = std::make_shared<Mapping>(static_cast<const char*>(addr), len);
+    std::atomic_store(&seg.mapping, mapping);
+    return mapping;
+}
+
+bool ObjectStorage::locate(int key, Location& entry, std::shared_ptr<Segment>& file) {
+    {
+        // 在分片锁内取得段的引用，压缩删除段之前会先把条目改到新位置
+        MetadataShard& shard = metadataShard(key);
+        std::shared_lock<std::shared_mutex> lock(shard.mutex);
+        if (!shard.filter.mayContain(key) || !shard.map.find(key, entry)) {
+            // 在分片锁内记录，之后写入该key的写者会在独占锁内清除
+            negative.insert(key);
+            return false;
+        }
+        file = findSegment(entry.segment);
+    }
+    if (!file) {
+        throw std::runtime_error("日志段不存在: " + segmentPath(dataPath, entry.segment));
+    }
+    return true;
+}
+
+void ObjectStorage::fillCache(int key, const Location& entry, const ValueRef& data) {
+    // 读盘期间对象可能被覆盖、删除或被压缩搬走，只有位置未变时才回填缓存
+    MetadataShard& shard = metadataShard(key);
+    std::shared_lock<std::shared_mutex> lock(shard.mutex);
+    Location now;
+    if (shard.map.find(key, now) && now.segment == entry.segment && now.offset == entry.offset) {
+        cache.put(key, data);
+    }
+}
+
+ValueRef ObjectStorage::getRef(int key) {
+    // 空对象也是有效的缓存条目，用句柄是否引用对象判断命中
+    ValueRef cached = cache.get(key);
+    if (cached) return cached;
+    if (negative.contains(key)) return {};
+
+    Location entry;
+    std::shared_ptr<Segment> file;
+    if (!locate(key, entry, file)) return {};
+
+    if (options.readMode == ReadMode::Mmap) {
+        // 日志记录写入后不再修改，视图一直有效；页缓存本身就是缓存，不再回填LRU
+        std::shared_ptr<const Mapping> mapping = mapSegment(*file, entry.offset + entry.size);
+        return ValueRef(mapping, mapping->addr + entry.offset, entry.size);
+    }
+
+    if (options.directIO) {
+        ValueRef data = readDirect(*file, entry.offset, entry.size);
+        fillCache(key, entry, data);
+        return data;
+    }
+
+    // 直接读入共享缓冲区，同一份数据既返回给调用方也放入缓存
+    char* buf = nullptr;
+    ValueRef data = ValueRef::allocate(entry.size, &buf);
+    ssize_t n = pread(file->fd, buf, entry.size, entry.offset);
+    if (n != static_cast<ssize_t>(entry.size)) {
+        throw std::runtime_error("读取数据文件失败: " + file->path);
+    }
+    fillCache(key, entry, data);
+    return data;
+}
+
+AlignedBufferPool::Buffer ObjectStorage::readBlocks(const Segment& file, uint64_t begin, uint64_t end) {
+    uint64_t first = begin & ~static_cast<uint64_t>(kDirectBlock - 1);
+    AlignedBufferPool::Buffer block = directBuffers.acquire(static_cast<size_t>(end - first));
+    size_t len = directBuffers.roundUp(static_cast<size_t>(end - first));
+    // 活动段的末块可能没有写满，读到文件末尾即可
+    ssize_t n = pread(file.fd, block.data(), len, first);
+    if (n < static_cast<ssize_t>(end - first)) {
+        throw std::runtime_error("读取数据文件失败: " + file.path);
+    }
+    return block;
+}
+
+ValueRef ObjectStorage::readDirect(const Segment& file, uint64_t offset, uint32_t size) {
+    // 对齐读入池中的缓冲区后复制出对象，缓冲区马上归还，缓存中只保留对象本身
+    AlignedBufferPool::Buffer block = readBlocks(file, offset, offset + size);
+    char* buf = nullptr;
+    ValueRef data = ValueRef::allocate(size, &buf);
+    std::memcpy(buf, block.data() + (offset & (kDirectBlock - 1)), size);
+    return data;
+}
+
+std::vector<ValueRef> ObjectStorage::multiGet(const std::vector<int>& keys) {
+    if (keys.size() == 1) return {getRef(keys[0])};
+
+    std::vector<ValueRef> values;
+    cache.getMany(keys, values);
+
+    // 未命中的key按元数据分片分组，每个分片只加一次共享锁
+    std::vector<uint32_t> misses;
+    std::vector<uint32_t> shardOf;
+    for (size_t i = 0; i < keys.size(); ++i) {
+        if (values[i] || negative.contains(keys[i])) continue;
+        misses.push_back(static_cast<uint32_t>(i));
+        shardOf.push_back(static_cast<uint32_t>(metadataShardIndex(keys[i])));
+    }
+    if (misses.empty()) return values;
+    std::vector<uint32_t> order;
+    orderByShard(shardOf, kMetadataShards, order);
+
+    // reads按元数据分片排列，回填缓存时沿用这个顺序
+    std::vector<PendingRead> reads;
+    reads.reserve(misses.size());
+    std::vector<std::shared_ptr<Segment>> files;  // 本批已取得的段，通常只有几个
+    size_t g = 0;
+    while (g < order.size()) {
+        uint32_t s = shardOf[order[g]];
+        MetadataShard& shard = metadataMap[s];
+        std::shared_lock<std::shared_mutex> lock(shard.mutex);
+        for (; g < order.size() && shardOf[order[g]] == s; ++g) {
+            size_t slot = misses[order[g]];
+            Location entry;
+            if (!shard.filter.mayContain(keys[slot]) || !shard.map.find(keys[slot], entry)) {
+                negative.insert(keys[slot]);
+                continue;
+            }
+            // 同一批中已经取得的段直接复用，段在持有引用期间不会关闭
+            std::shared_ptr<Segment> file;
+            for (const auto& f : files) {
+                if (f->id == entry.segment) file = f;
+            }
+            if (!file) {
+                file = findSegment(entry.segment);
+                if (!file) {
+                    throw std::runtime_error("日志段不存在: " + segmentPath(dataPath, entry.segment));
+                }
+                files.push_back(file);
+            }
+            reads.push_back({slot, keys[slot], entry, std::move(file), ValueRef()});
+        }
+    }
+
+    if (options.readMode == ReadMode::Mmap) {
+        for (PendingRead& r : reads) {
+            std::shared_ptr<const Mapping> mapping = mapSegment(*r.file, r.entry.offset + r.entry.size);
+            values[r.slot] = ValueRef(mapping, mapping->addr + r.entry.offset, r.entry.size);
+        }
+        return values;
+    }
+
+    readCoalesced(reads);
+
+    // 回填缓存同样每个分片加一次锁，在元数据分片锁内确认位置未变
+    std::vector<std::pair<int, ValueRef>> fill;
+    g = 0;
+    while (g < reads.size()) {
+        size_t s = metadataShardIndex(reads[g].key);
+        MetadataShard& shard = metadataMap[s];
+        std::shared_lock<std::shared_mutex> lock(shard.mutex);
+        fill.clear();
+        for (; g < reads.size() && metadataShardIndex(reads[g].key) == s; ++g) {
+            const PendingRead& r = reads[g];
+            values[r.slot] = r.data;
+            Location now;
+            if (shard.map.find(r.key, now) && now.segment == r.entry.segment && now.offset == r.entry.offset) {
+                fill.emplace_back(r.key, r.data);
+            }
+        }
+        cache.putMany(fill);
+    }
+    return values;
+}
+
+void ObjectStorage::readCoalesced(std::vector<PendingRead>& reads) {
+    // 只排序下标，reads本身的顺序不变
+    std::vector<uint32_t> order(reads.size());
+    for (uint32_t i = 0; i < order.size(); ++i) order[i] = i;
+    std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+        const Location& x = reads[a].entry;
+        const Location& y = reads[b].entry;
+        if (x.segment != y.segment) return x.segment < y.segment;
+        return x.offset < y.offset;
+    });
+
+    // 记录之间的间隔(记录头和不需要的记录)读到同一块丢弃区
+    // directIO模式下整段对齐读入池中的缓冲区，再把各个对象复制出来
+    struct Target {
+        char* buf;
+        uint64_t offset;
+        uint32_t size;
+    };
+    std::vector<char> gap;
+    std::vector<struct iovec> iov;
+    std::vector<Target> targets;
+    size_t i = 0;
+    while (i < order.size()) {
+        PendingRead& first = reads[order[i]];
+        uint64_t begin = first.entry.offset;
+        uint64_t end = begin;
+        iov.clear();
+        targets.clear();
+        size_t j = i;
+        for (; j < order.size(); ++j) {
+            PendingRead& r = reads[order[j]];
+            const Location& e = r.entry;
+            if (j > i) {
+                const PendingRead& prev = reads[order[j - 1]];
+                if (e.segment != first.entry.segment) break;
+                if (e.offset == prev.entry.offset) {
+                    // 同一key重复出现，共享同一份数据
+                    r.data = prev.data;
+                    continue;
+                }
+                if (e.offset - end > kCoalesceGap || e.offset + e.size - begin > kCoalesceSpan
+                    || iov.size() + 2 > IOV_MAX) {
+                    break;
+                }
+                if (e.offset > end && !options.directIO) {
+                    if (gap.empty()) gap.resize(kCoalesceGap);
+                    iov.push_back({gap.data(), static_cast<size_t>(e.offset - end)});
+                }
+            }
+            char* buf = nullptr;
+            r.data = ValueRef::allocate(e.size, &buf);
+            iov.push_back({buf, e.size});
+            targets.push_back({buf, e.offset, e.size});
+            end = e.offset + e.size;
+        }
+
+        if (options.directIO) {
+            AlignedBufferPool::Buffer block = readBlocks(*first.file, begin, end);
+            uint64_t base = begin & ~static_cast<uint64_t>(kDirectBlock - 1);
+            for (const Target& t : targets) {
+                std::memcpy(t.buf, block.data() + (t.offset - base), t.size);
+            }
+            i = j;
+            continue;
+        }
+        ssize_t n = preadv(first.file->fd, iov.data(), static_cast<int>(iov.size()), begin);
+        if (n != static_cast<ssize_t>(end - begin)) {
+            throw std::runtime_error("读取数据文件失败: " + first.file->path);
+        }
+        i = j;
+    }
+}
+
+size_t ObjectStorage::scan(int start, int end, const ScanCallback& fn) {
+    if (start >= end) return 0;
+
+    // 每个元数据分片一个游标，保存从该分片取出的一批按key排好序的位置，取完后再取下一批
+    struct Cursor {
+        std::vector<std::pair<int, Location>> items;
+        size_t pos = 0;
+        int next = 0;            // 下一批的起点
+        bool exhausted = false;  // 分片中的范围已全部取出
+    };
+    std::vector<Cursor> cursors(kMetadataShards);
+    auto refill = [&](size_t s) {
+        Cursor& c = cursors[s];
+        c.items.clear();
+        c.pos = 0;
+        if (c.exhausted) return false;
+        {
+            const MetadataShard& shard = metadataMap[s];
+            std::shared_lock<std::shared_mutex> lock(shard.mutex);
+            c.exhausted = shard.map.collect(c.next, end, kScanBatch, c.items);
+        }
+        // 取出的key都小于end，加一不会溢出
+        if (!c.items.empty()) c.next = c.items.back().first + 1;
+        return !c.items.empty();
+    };
+
+    // 各分片游标的当前key组成最小堆，依次取出最小的key完成归并
+    using Head = std::pair<int, size_t>;
+    std::priority_queue<Head, std::vector<Head>, std::greater<Head>> heads;
+    for (size_t s = 0; s < kMetadataShards; ++s) {
+        cursors[s].next = start;
+        if (refill(s)) heads.push(Head(cursors[s].items[0].first, s));
+    }
+
+    // 按key的顺序取出下一批位置并取得所在的段；段已被压缩删除时file为空，读取时按key重新查找
+    auto nextBatch = [&](std::vector<PendingRead>& reads) {
+        reads.clear();
+        while (reads.size() < kScanBatch && !heads.empty()) {
+            size_t s = heads.top().second;
+            heads.pop();
+            Cursor& c = cursors[s];
+            const std::pair<int, Location>& item = c.items[c.pos++];
+            reads.push_back({reads.size(), item.first, item.second, nullptr, ValueRef()});
+            if (c.pos < c.items.size() || refill(s)) heads.push(Head(c.items[c.pos].first, s));
+        }
+        std::vector<std::shared_ptr<Segment>> files;
+        for (PendingRead& r : reads) {
+            for (const auto& f : files) {
+                if (f->id == r.entry.segment) r.file = f;
+            }
+            if (!r.file) {
+                r.file = findSegment(r.entry.segment);
+                if (r.file) files.push_back(r.file);
+            }
+        }
+    };
+
+    // 回调处理当前一批时，下一批已经取出位置并提交预读，回调之后再读入
+    std::vector<PendingRead> current;
+    std::vector<PendingRead> upcoming;
+    nextBatch(current);
+    readScanBatch(current);
+    size_t visited = 0;
+    while (!current.empty()) {
+        nextBatch(upcoming);
+        prefetch(upcoming);
+        for (const PendingRead& r : current) {
+            if (!r.data) continue;   // 重新查找时对象已被删除
+            ++visited;
+            if (!fn(r.key, r.data)) return visited;
+        }
+        readScanBatch(upcoming);
+        current.swap(upcoming);
+    }
+    return visited;
+}
+
+void ObjectStorage::readScanBatch(std::vector<PendingRead>& reads) {
+    if (options.readMode == ReadMode::Mmap) {
+        for (PendingRead& r : reads) {
+            if (!r.file) continue;
+            std::shared_ptr<const Mapping> mapping = mapSegment(*r.file, r.entry.offset + r.entry.size);
+            r.data = ValueRef(mapping, mapping->addr + r.entry.offset, r.entry.size);
+        }
+    } else {
+        bool moved = false;
+        for (const PendingRead& r : reads) moved |= !r.file;
+        if (!moved) {
+            readCoalesced(reads);
+        } else {
+            std::vector<PendingRead> present;
+            for (const PendingRead& r : reads) {
+                if (r.file) present.push_back(r);
+            }
+            readCoalesced(present);
+            for (PendingRead& r : present) reads[r.slot].data = std::move(r.data);
+        }
+    }
+    // 位置是在分片锁外使用的，段可能已被压缩删除，此时对象已搬到新位置(或被删除)，按key重新读取
+    for (PendingRead& r : reads) {
+        if (!r.file) r.data = getRef(r.key);
+    }
+}
+
+void ObjectStorage::prefetch(const std::vector<PendingRead>& reads) {
+    // directIO绕过页缓存，预读没有意义
+    if (options.directIO) return;
+    std::vector<const PendingRead*> order;
+    order.reserve(reads.size());
+    for (const PendingRead& r : reads) {
+        if (r.file) order.push_back(&r);
+    }
+    std::sort(order.begin(), order.end(), [](const PendingRead* a, const PendingRead* b) {
+        if (a->entry.segment != b->entry.segment) return a->entry.segment < b->entry.segment;
+        return a->entry.offset < b->entry.offset;
+    });
+    size_t i = 0;
+    while (i < order.size()) {
+        const PendingRead* first = order[i];
+        uint64_t begin = first->entry.offset;
+        uint64_t rangeEnd = begin + first->entry.size;
+        for (++i; i < order.size(); ++i) {
+            const Location& e = order[i]->entry;
+            if (e.segment != first->entry.segment || e.offset > rangeEnd + kCoalesceGap) break;
+            rangeEnd = std::max(rangeEnd, e.offset + e.size);
+        }
+        posix_fadvise(first->file->fd, static_cast<off_t>(begin), static_cast<off_t>(rangeEnd - begin),
+                      POSIX_FADV_WILLNEED);
+    }
+}
+
+AsyncIO& ObjectStorage::asyncIO() {
+    std::call_once(ioOnce, [this]() {
+        io = AsyncIO::create(options.ioBackend, options.ioQueueDepth, options.ioThreads);
+    });
+    return *io;
+}
+
+void ObjectStorage::getAsync(int key, GetCallback callback) {
+    Location entry;
+    std::shared_ptr<Segment> file;
+    try {
+        ValueRef cached = cache.get(key);
+        if (cached || negative.contains(key) || !locate(key, entry, file)) {
+            callback(cached, nullptr);
+            return;
+        }
+        if (options.readMode == ReadMode::Mmap) {
+            // 映射读取不会阻塞在系统调用上，直接返回视图
+            callback(getRef(key), nullptr);
+            return;
+        }
+    } catch (...) {
+        callback(ValueRef(), std::current_exception());
+        return;
+    }
+
+    // 回调持有段的引用，读取完成前段即使被压缩删除，描述符也保持打开
+    if (options.directIO) {
+        // 按块对齐读入池中的缓冲区，完成后复制出对象
+        uint64_t first = entry.offset & ~static_cast<uint64_t>(kDirectBlock - 1);
+        size_t need = static_cast<size_t>(entry.offset + entry.size - first);
+        std::shared_ptr<AlignedBufferPool::Buffer> block =
+            std::make_shared<AlignedBufferPool::Buffer>(directBuffers.acquire(need));
+        asyncIO().read(file->fd, block->data(), directBuffers.roundUp(need), first,
+            [this, key, entry, file, block, first, need, callback](ssize_t n) {
+                if (n < static_cast<ssize_t>(need)) {
+                    callback(ValueRef(), std::make_exception_ptr(
+                        std::runtime_error("读取数据文件失败: " + file->path)));
+                    return;
+                }
+                char* buf = nullptr;
+                ValueRef data = ValueRef::allocate(entry.size, &buf);
+                std::memcpy(buf, block->data() + (entry.offset - first), entry.size);
+                fillCache(key, entry, data);
+                callback(data, nullptr);
+            });
+        return;
+    }
+
+    char* buf = nullptr;
+    ValueRef data = ValueRef::allocate(entry.size, &buf);
+    asyncIO().read(file->fd, buf, entry.size, entry.offset,
+        [this, key, entry, file, data, callback](ssize_t n) {
+            if (n != static_cast<ssize_t>(entry.size)) {
+                callback(ValueRef(), std::make_exception_ptr(
+                    std::runtime_error("读取数据文件失败: " + file->path)));
+                return;
+            }
+            fillCache(key, entry, data);
+            callback(data, nullptr);
+        });
+}
+
+std::future<ValueRef> ObjectStorage::getAsync(int key) {
+    std::shared_ptr<std::promise<ValueRef>> promise = std::make_shared<std::promise<ValueRef>>();
+    std::future<ValueRef> result = promise->get_future();
+    getAsync(key, [promise](ValueRef value, std::exception_ptr error) {
+        if (error) {
+            promise->set_exception(error);
+        } else {
+            promise->set_value(std::move(value));
+        }
+    });
+    return result;
+}
+
+void ObjectStorage::del(int key) {
+    // 追加墓碑记录，重启后扫描日志也能识别删除
+    WriteRequest req = {datalog::FLAG_TOMBSTONE, key, ValueRef(), false, nullptr, nullptr};
+    submit(&req, 1);
+}
+
+size_t ObjectStorage::size() const {
+    size_t total = 0;
+    for (const auto& shard : metadataMap) {
+        std::shared_lock<std::shared_mutex> lock(shard.mutex);
+        total += shard.map.size();
+    }
+    return total;
+}
+
+void ObjectStorage::recover() {
+    // 构造期间没有并发访问，直接修改分片和段表，不加锁
+    std::map<uint32_t, std::string> found = listSegments(dataPath);
+    struct stat st;
+    if (found.empty() && stat(dataPath.c_str(), &st) == 0 && S_ISREG(st.st_mode)) {
+        // 旧版本的单文件日志直接作为第一个段，索引格式不同会被重建
+        std::string first = segmentPath(dataPath, 1);
+        if (std::rename(dataPath.c_str(), first.c_str()) != 0) {
+            throw std::runtime_error("无法转换数据文件: " + dataPath);
+        }
+        found[1] = first;
+    }
+    for (const auto& kv : found) {
+        segments[kv.first] = std::make_shared<Segment>(kv.first, kv.second, options.directIO);
+    }
+
+    auto segmentSize = [this](uint32_t id) -> uint64_t {
+        auto it = segments.find(id);
+        return it != segments.end() ? it->second->bytes : 0;
+    };
+    // 过滤器文件覆盖索引快照中的key，快照之后写入的key记下来，确认文件可用后再补进过滤器
+    SavedFilters saved;
+    bool haveSaved = options.filterBitsPerKey != 0 && readFilters(saved);
+    std::vector<int> added;
+    index.load(segmentSize, [&](const IndexFile::Record& rec, size_t ordinal) {
+        if (rec.op == IndexFile::OP_PUT) {
+            Location entry = {rec.segment, rec.offset, rec.size};
+            metadataShard(rec.key).map.assign(rec.key, entry);
+            if (haveSaved && ordinal >= saved.records) added.push_back(rec.key);
+        } else {
+            metadataShard(rec.key).map.erase(rec.key);
+        }
+    });
+    bool filtersLoaded = haveSaved && saved.dataSegment == index.snapshotSegment()
+        && saved.dataEnd == index.snapshotEnd() && saved.records <= index.recordCount();
+    if (filtersLoaded) {
+        for (size_t i = 0; i < kMetadataShards; ++i) {
+            metadataMap[i].filter = std::move(saved.filters[i]);
+            metadataMap[i].filterAdds = saved.adds[i];
+        }
+        for (int key : added) filterAdd(metadataShard(key), key);
+    }
+    added = std::vector<int>();
+
+    // 索引没有覆盖到的日志(或索引丢失时的全部日志)按段顺序扫描补齐
+    std::vector<IndexFile::Record> replayed;
+    for (auto& kv : segments) {
+        Segment& seg = *kv.second;
+        if (seg.id < index.dataSegment()) continue;
+        uint64_t start = seg.id == index.dataSegment() ? index.dataEnd() : 0;
+
+        datalog::LogScanner scanner(seg.path);
+        uint64_t validEnd = scanner.scan(start,
+            [&](const datalog::RecordHeader& header, uint64_t offset, const char*) {
+                IndexFile::Record rec;
+                std::memset(&rec, 0, sizeof(rec));
+                rec.key = header.key;
+                rec.segment = seg.id;
+                rec.offset = offset;
+                if (header.flags == datalog::FLAG_PUT) {
+                    rec.op = IndexFile::OP_PUT;
+                    rec.size = header.length;
+                    Location entry = {seg.id, offset, header.length};
+                    metadataShard(header.key).map.assign(header.key, entry);
+                    if (filtersLoaded) filterAdd(metadataShard(header.key), header.key);
+                } else {
+                    rec.op = IndexFile::OP_DEL;
+                    metadataShard(header.key).map.erase(header.key);
+                }
+                if (replayed.size() <= kMaxIndexAppend) replayed.push_back(rec);
+            });
+
+        if (validEnd < seg.bytes) {
+            if (seg.id != segments.rbegin()->first) {
+                // 封存段已经刷过盘，中间损坏只能放弃该段剩余的记录
+                std::cerr << "日志段损坏，忽略 " << seg.path << " 中 " << validEnd << " 之后的数据" << std::endl;
+                continue;
+            }
+            // 截掉活动段写了一半的残缺记录
+            if (truncate(seg.path.c_str(), validEnd) != 0) {
+                throw std::runtime_error("无法截断数据文件: " + seg.path);
+            }
+            seg.bytes = validEnd;
+        }
+    }
+
+    for (const auto& shard : metadataMap) {
+        shard.map.forEach([this](int, const Location& e) {
+            segments.at(e.segment)->liveBytes += recordBytes(e.size);
+        });
+    }
+
+    // 最后一个段继续作为活动段，没有段时创建第一个
+    uint32_t activeId = segments.empty() ? 1 : segments.rbegin()->first;
+    std::string activePath = segmentPath(dataPath, activeId);
+    openActive(activePath, O_CREAT, segments.empty() ? 0 : segments.rbegin()->second->bytes);
+    if (segments.empty()) {
+        segments[activeId] = std::make_shared<Segment>(activeId, activePath, options.directIO);
+    }
+    active = segments[activeId];
+
+    // 补齐索引：少量记录直接追加，大量记录或失效记录过多时整体重写(同时重建过滤器)
+    if (replayed.size() > kMaxIndexAppend || index.recordCount() > 2 * size() + 1024) {
+        rewriteIndex();
+        return;
+    }
+    for (const auto& rec : replayed) {
+        index.append(rec.op, rec.key, rec.segment, rec.offset, rec.size);
+    }
+    if (!filtersLoaded) {
+        for (MetadataShard& shard : metadataMap) rebuildFilter(shard);
+    }
+}
+
+void ObjectStorage::checkpoint() {
+    // 持有writeMutex期间没有新的追加，快照与活动段末尾一致
+    std::lock_guard<std::mutex> writeLock(writeMutex);
+    rewriteIndex();
+}
+
+void ObjectStorage::rewriteIndex() {
+    std::vector<IndexFile::Record> live;
+    live.reserve(size());
+    for (auto& shard : metadataMap) {
+        // 持有writeMutex时元数据不会变化，独占锁只为替换过滤器
+        std::unique_lock<std::shared_mutex> lock(shard.mutex);
+        rebuildFilter(shard);
+        shard.map.forEach([&live](int key, const Location& e) {
+            IndexFile::Record rec;
+            std::memset(&rec, 0, sizeof(rec));
+            rec.op = IndexFile::OP_PUT;
+            rec.key = key;
+            rec.size = e.size;
+            rec.segment = e.segment;
+            rec.offset = e.offset;
+            live.push_back(rec);
+        });
+    }
+    // 先保存过滤器再切换索引，两者之间崩溃时过滤器与索引的快照位置不一致，打开时会被重建
+    if (options.filterBitsPerKey != 0) saveFilters(active->id, active->bytes, live.size());
+    index.rewrite(live, active->id, active->bytes);
+}
+
+void ObjectStorage::filterAdd(MetadataShard& shard, int key) {
+    if (options.filterBitsPerKey == 0) return;
+    if (shard.filterAdds >= shard.filter.capacity()) {
+        // 与哈希表扩容一样在独占锁内完成，容量翻倍，均摊到每次写入是常数
+        rebuildFilter(shard);
+        return;
+    }
+    shard.filter.add(key);
+    ++shard.filterAdds;
+}
+
+void ObjectStorage::rebuildFilter(MetadataShard& shard) {
+    if (options.filterBitsPerKey == 0) return;
+    size_t keys = 2 * shard.map.size();
+    if (keys < kMinFilterKeys) keys = kMinFilterKeys;
+    BloomFilter filter(keys, options.filterBitsPerKey);
+    shard.map.forEach([&filter](int key, const Location&) { filter.add(key); });
+    shard.filter = std::move(filter);
+    shard.filterAdds = shard.map.size();
+}
+
+size_t ObjectStorage::filterBytes() const {
+    size_t total = 0;
+    for (const auto& shard : metadataMap) {
+        std::shared_lock<std::shared_mutex> lock(shard.mutex);
+        total += shard.filter.memoryBytes();
+    }
+    return total;
+}
+
+size_t ObjectStorage::indexBytes() const {
+    size_t total = 0;
+    for (const auto& shard : metadataMap) {
+        std::shared_lock<std::shared_mutex> lock(shard.mutex);
+        total += shard.map.memoryBytes();
+    }
+    return total;
+}
+
+namespace {
+
+// 过滤器文件: [FilterFileHeader] 每个分片[容量 已加入数 块数 块数组] [前面全部内容的CRC32C]
+struct FilterFileHeader {
+    char magic[8];          // "OSFILTR1"
+    uint32_t version;
+    uint32_t bitsPerKey;
+    uint32_t shards;
+    uint32_t dataSegment;   // 对应索引快照的日志末尾
+    uint64_t dataEnd;
+    uint64_t records;       // 索引快照的记录数
+};
+
+const char kFilterMagic[8] = {'O', 'S', 'F', 'I', 'L', 'T', 'R', '1'};
+const uint32_t kFilterVersion = 1;
+
+void appendBytes(std::vector<char>& buf, const void* data, size_t len) {
+    const char* p = static_cast<const char*>(data);
+    buf.insert(buf.end(), p, p + len);
+}
+
+} // namespace
+
+void ObjectStorage::saveFilters(uint32_t dataSegment, uint64_t dataEnd, size_t records) {
+    FilterFileHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, kFilterMagic, sizeof(kFilterMagic));
+    header.version = kFilterVersion;
+    header.bitsPerKey = options.filterBitsPerKey;
+    header.shards = kMetadataShards;
+    header.dataSegment = dataSegment;
+    header.dataEnd = dataEnd;
+    header.records = records;
+
+    std::vector<char> buf;
+    appendBytes(buf, &header, sizeof(header));
+    for (const auto& shard : metadataMap) {
+        std::shared_lock<std::shared_mutex> lock(shard.mutex);
+        uint64_t fields[3] = {shard.filter.capacity(), shard.filterAdds, shard.filter.blockCount()};
+        appendBytes(buf, fields, sizeof(fields));
+        appendBytes(buf, shard.filter.data(), shard.filter.memoryBytes());
+    }
+    uint32_t crc = crc32c::value(buf.data(), buf.size());
+    appendBytes(buf, &crc, sizeof(crc));
+
+    std::string path = dataPath + ".filter";
+    std::string tmpPath = path + ".tmp";
+    int fd = open(tmpPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        throw std::runtime_error("无法创建过滤器文件: " + tmpPath);
+    }
+    bool ok = write(fd, buf.data(), buf.size()) == static_cast<ssize_t>(buf.size()) && fsync(fd) == 0;
+    close(fd);
+    if (!ok || std::rename(tmpPath.c_str(), path.c_str()) != 0) {
+        throw std::runtime_error("写入过滤器文件失败: " + path);
+    }
+}
+
+bool ObjectStorage::readFilters(SavedFilters& saved) {
+    std::string path = dataPath + ".filter";
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    std::vector<char> buf;
+    if (fstat(fd, &st) == 0) {
+        buf.resize(static_cast<size_t>(st.st_size));
+        if (pread(fd, buf.data(), buf.size(), 0) != static_cast<ssize_t>(buf.size())) buf.clear();
+    }
+    close(fd);
+
+    FilterFileHeader header;
+    if (buf.size() < sizeof(header) + sizeof(uint32_t)) return false;
+    size_t body = buf.size() - sizeof(uint32_t);
+    uint32_t crc;
+    std::memcpy(&crc, buf.data() + body, sizeof(crc));
+    std::memcpy(&header, buf.data(), sizeof(header));
+    if (crc != crc32c::value(buf.data(), body) || std::memcmp(header.magic, kFilterMagic, sizeof(kFilterMagic)) != 0
+        || header.version != kFilterVersion || header.bitsPerKey != options.filterBitsPerKey
+        || header.shards != kMetadataShards) {
+        return false;
+    }
+
+    saved.dataSegment = header.dataSegment;
+    saved.dataEnd = header.dataEnd;
+    saved.records = header.records;
+    size_t pos = sizeof(header);
+    for (size_t i = 0; i < kMetadataShards; ++i) {
+        uint64_t fields[3];
+        if (body - pos < sizeof(fields)) return false;
+        std::memcpy(fields, buf.data() + pos, sizeof(fields));
+        pos += sizeof(fields);
+        if ((body - pos) / sizeof(BloomFilter::Block) < fields[2]) return false;
+        saved.filters.push_back(BloomFilter::fromBlocks(fields[0], buf.data() + pos, fields[2]));
+        saved.adds.push_back(fields[1]);
+        pos += fields[2] * sizeof(BloomFilter::Block);
+    }
+    return pos == body;
+}
+
+ObjectStorage::SpaceStats ObjectStorage::spaceStats() {
+    std::lock_guard<std::mutex> writeLock(writeMutex);
+    SpaceStats stats = {0, 0, compactions, segments.size()};
+    for (const auto& kv : segments) {
+        stats.fileBytes += kv.second->bytes;
+        stats.liveBytes += kv.second->liveBytes;
+    }
+    return stats;
+}
+
+void ObjectStorage::setCompactionRateLimit(uint64_t bytesPerSecond) {
+    std::lock_guard<std::mutex> compactLock(compactMutex);
+    options.compactionRateLimit = bytesPerSecond;
+}
+
+std::vector<uint32_t> ObjectStorage::compactionCandidates() {
+    std::vector<std::pair<uint64_t, uint32_t>> dead;  // (失效字节, 段号)
+    for (const auto& kv : segments) {
+        const Segment& seg = *kv.second;
+        if (kv.second == active || seg.bytes == 0) continue;
+        uint64_t garbage = seg.bytes - seg.liveBytes;
+        if (static_cast<double>(garbage) >= options.compactionRatio * seg.bytes) {
+            dead.emplace_back(garbage, seg.id);
+        }
+    }
+    std::sort(dead.begin(), dead.end(), std::greater<std::pair<uint64_t, uint32_t>>());
+    std::vector<uint32_t> ids;
+    for (const auto& d : dead) ids.push_back(d.second);
+    return ids;
+}
+
+bool ObjectStorage::needsCompaction() {
+    std::lock_guard<std::mutex> writeLock(writeMutex);
+    uint64_t dead = 0;
+    for (const auto& kv : segments) dead += kv.second->bytes - kv.second->liveBytes;
+    return dead >= options.compactionMinBytes && !compactionCandidates().empty();
+}
+
+void ObjectStorage::compactionLoop() {
+    std::unique_lock<std::mutex> lock(backgroundMutex);
+    while (!stopping) {
+        backgroundCv.wait_for(lock, std::chrono::seconds(1));
+        if (stopping) break;
+        lock.unlock();
+        try {
+            if (needsCompaction()) compact();
+        } catch (const std::exception& e) {
+            std::cerr << "compaction failed: " << e.what() << std::endl;
+        }
+        lock.lock();
+    }
+}
+
+bool ObjectStorage::compact() {
+    std::lock_guard<std::mutex> compactLock(compactMutex);
+    std::vector<uint32_t> ids;
+    {
+        std::lock_guard<std::mutex> writeLock(writeMutex);
+        ids = compactionCandidates();
+    }
+    bool compacted = false;
+    for (uint32_t id : ids) {
+        {
+            std::lock_guard<std::mutex> lock(backgroundMutex);
+            if (stopping) break;
+        }
+        compacted |= relocateSegment(id);
+    }
+    return compacted;
+}
+
+bool ObjectStorage::compactSegment(uint32_t id) {
+    std::lock_guard<std::mutex> compactLock(compactMutex);
+    return relocateSegment(id);
+}
+
+bool ObjectStorage::relocateSegment(uint32_t id) {
+    std::shared_ptr<Segment> victim;
+    bool keepTombstones;
+    {
+        std::lock_guard<std::mutex> writeLock(writeMutex);
+        auto it = segments.find(id);
+        if (it == segments.end() || it->second == active) return false;
+        victim = it->second;
+        // 更早的段里可能还有被删除key的旧记录，墓碑要保留到最老的段为止
+        keepTombstones = segments.begin()->first < id;
+    }
+
+    // 待搬迁的记录，value暂存在buffer中，攒够一块后在writeMutex下重新追加
+    struct Pending {
+        uint8_t flags;
+        int key;
+        uint64_t offset;     // 在旧段中的偏移
+        uint32_t size;
+        size_t pos;          // 在buffer中的位置
+    };
+    const size_t kChunk = 1 << 20;
+    std::vector<Pending> pending;
+    std::vector<char> buffer;
+    buffer.reserve(kChunk);
+
+    auto flush = [&]() {
+        std::lock_guard<std::mutex> writeLock(writeMutex);
+        // 与writeBatch相同：整块记录一次写入数据文件，再一次追加索引记录，最后更新元数据
+        std::vector<datalog::RecordHeader> headers(pending.size());
+        std::vector<Location> entries(pending.size());
+        std::vector<Segment*> targets(pending.size(), nullptr);   // 记录写入的段，为空表示不搬迁
+        std::vector<struct iovec> iov;
+        iov.reserve(pending.size() * 2);
+        std::vector<IndexFile::Record> records;
+        records.reserve(pending.size());
+
+        uint64_t start = active->bytes;
+        uint64_t pos = start;
+        for (size_t i = 0; i < pending.size(); ++i) {
+            const Pending& p = pending[i];
+            // 持有writeMutex时元数据不会变化，可以不加分片锁读取
+            Location now;
+            bool live = metadataShard(p.key).map.find(p.key, now);
+            if (p.flags == datalog::FLAG_PUT) {
+                // 扫描之后被覆盖或删除的记录不再搬迁
+                if (!live || now.segment != id || now.offset != p.offset) continue;
+            } else if (live) {
+                continue;  // key已重新写入，墓碑不再需要
+            }
+
+            uint64_t total = recordBytes(p.size);
+            if (pos > 0 && pos + total > options.segmentBytes) {
+                // 活动段放不下，先写出已攒的部分再切换到新段
+                writeVectors(iov, start);
+                active->bytes = pos;
+                rollSegment();
+                start = pos = active->bytes;
+            }
+
+            const char* data = p.size > 0 ? buffer.data() + p.pos : nullptr;
+            headers[i] = datalog::makeHeader(p.flags, p.key, data, p.size);
+            iov.push_back({&headers[i], sizeof(datalog::RecordHeader)});
+            if (p.size > 0) iov.push_back({const_cast<char*>(data), p.size});
+            entries[i] = {active->id, pos + sizeof(datalog::RecordHeader), p.size};
+            targets[i] = active.get();
+            pos += total;
+
+            IndexFile::Record rec;
+            std::memset(&rec, 0, sizeof(rec));
+            rec.op = p.flags == datalog::FLAG_PUT ? IndexFile::OP_PUT : IndexFile::OP_DEL;
+            rec.key = p.key;
+            rec.size = p.size;
+            rec.segment = entries[i].segment;
+            rec.offset = entries[i].offset;
+            records.push_back(rec);
+        }
+        // 数据先落到文件，再写索引记录，最后让读者看到新位置
+        writeVectors(iov, start);
+        active->bytes = pos;
+        index.append(records);
+
+        for (size_t i = 0; i < pending.size(); ++i) {
+            if (targets[i] == nullptr || pending[i].flags != datalog::FLAG_PUT) continue;
+            victim->liveBytes -= recordBytes(pending[i].size);
+            targets[i]->liveBytes += recordBytes(pending[i].size);
+            MetadataShard& shard = metadataShard(pending[i].key);
+            std::unique_lock<std::shared_mutex> lock(shard.mutex);
+            shard.map.assign(pending[i].key, entries[i]);
+        }
+        pending.clear();
+        buffer.clear();
+    };
+
+    // 限速顺序扫描旧段，封存段不再变化，扫描不需要加锁
+    RateLimiter limiter(options.compactionRateLimit);
+    datalog::LogScanner scanner(victim->path);
+    scanner.scan(0, [&](const datalog::RecordHeader& header, uint64_t offset, const char* value) {
+        limiter.acquire(recordBytes(header.length));
+        if (header.flags == datalog::FLAG_PUT) {
+            MetadataShard& shard = metadataShard(header.key);
+            std::shared_lock<std::shared_mutex> lock(shard.mutex);
+            Location now;
+            if (!shard.map.find(header.key, now) || now.segment != id || now.offset != offset) return;
+        } else if (!keepTombstones) {
+            return;
+        }
+        Pending p = {header.flags, header.key, offset, header.length, buffer.size()};
+        pending.push_back(p);
+        buffer.insert(buffer.end(), value, value + header.length);
+        if (buffer.size() >= kChunk) flush();
+    });
+    flush();
+
+    // 搬迁的记录和索引刷盘后才能删除旧段
+    std::lock_guard<std::mutex> writeLock(writeMutex);
+    if (victim->liveBytes != 0) {
+        throw std::runtime_error("日志段中仍有无法搬迁的记录: " + victim->path);
+    }
+    fdatasync(writeFd);
+    index.sync();
+    {
+        std::unique_lock<std::shared_mutex> lock(segmentsMutex);
+        segments.erase(id);
+    }
+    // 仍在读取该段的读者持有描述符，不受删除影响
+    unlink(victim->path.c_str());
+    ++compactions;
+    return true;
+}
+
+void ObjectStorage::printCache() {
+    cache.print();
+}
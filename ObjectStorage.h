@@ -0,0 +1,415 @@
+#ifndef OBJECT_STORAGE_H
+#define OBJECT_STORAGE_H
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <unordered_map>
+#include <map>
+#include <array>
+#include <mutex>
+#include <shared_mutex>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <deque>
+#include <exception>
+#include <chrono>
+#include <thread>
+#include <memory>
+#include <cstdint>
+#include <sys/uio.h>
+
+#include "AlignedBufferPool.h"
+#include "AsyncIO.h"
+#include "BloomFilter.h"
+#include "Hash.h"
+#include "IndexFile.h"
+#include "LRUCache.h"
+#include "MetadataIndex.h"
+#include "NegativeCache.h"
+#include "StorageEngine.h"
+
+// 文件布局：日志按大小切分为多个段 filename.000001, filename.000002 ...
+// 只有编号最大的活动段接受追加，写满后封存，封存段不再修改，只会被压缩整体删除
+//
+// 并发模型：
+// - 写入(put/del)采用组提交：请求进入写队列，队首的写者作为领导者把整批请求
+//   用一次pwritev写到活动段末尾，按同步策略刷盘后唤醒同批的其他写者
+// - 追加写由writeMutex串行化，只有领导者和压缩会持有
+// - 读取使用各段只读描述符上的pread，不依赖共享的文件偏移，读者之间互不加锁；
+//   mmap模式下直接返回段映射中的视图，不发生系统调用也不复制
+// - 异步接口(getAsync/putAsync)通过AsyncIO提交读请求，多个未命中缓存的读可以同时在途；
+//   异步写进入同一个组提交队列，没有同步写者带领时由提交线程负责写出
+// - directIO模式下日志段以O_DIRECT读写，绕过页缓存，内存预算只由LRU缓存使用：
+//   读取按4KB块对齐读入池中的缓冲区再复制出对象；追加写把未写满的末块留在暂存区，
+//   每批从末块起点整块重写，末尾补零，封存和关闭时截掉补零部分
+// - 元数据按key哈希分片，每个分片一把读写锁，读者只持有共享锁
+// - 压缩每次处理一个封存段：限速扫描，把仍然存活的记录重新追加到活动段，然后删除该段
+
+class ObjectStorage : public StorageEngine {
+public:
+    // 写入的刷盘策略
+    enum class SyncPolicy {
+        None,          // 不主动刷盘，由操作系统回写
+        Interval,      // 每隔syncIntervalMs刷盘一次，写者不等待刷盘
+        EveryBatch,    // 每批写入后刷盘，写者返回时数据已持久化
+    };
+
+    // 未命中缓存时的读取方式
+    enum class ReadMode {
+        Pread,         // pread到新分配的缓冲区，并回填缓存
+        Mmap,          // 映射日志段，返回指向页缓存的只读视图，不回填缓存
+    };
+
+    // mmap模式下传给madvise的访问模式
+    enum class MmapAdvice {
+        Normal,
+        Random,        // 关闭预读，适合随机点查
+        Sequential,    // 积极预读，适合顺序扫描
+    };
+
+    struct Options {
+        size_t cacheBytes = 64 << 20;                     // 缓存的字节预算
+        size_t negativeCacheSlots = 1 << 16;              // 负查找缓存的槽数(每槽8字节)，0为关闭
+        unsigned filterBitsPerKey = 10;                   // 元数据前的Bloom过滤器每个key的位数，0为关闭
+        bool orderedIndex = false;                        // 元数据使用B+树，scan只访问范围内的key；关闭时scan遍历整个哈希索引
+        CachePolicy cachePolicy = CachePolicy::LRU;       // 缓存淘汰策略
+        uint64_t segmentBytes = 64ull << 20;              // 日志段大小上限，写满后切换到新段
+        SyncPolicy syncPolicy = SyncPolicy::None;         // 刷盘策略
+        uint32_t syncIntervalMs = 100;                    // Interval策略的刷盘间隔
+        size_t writeBatchBytes = 4 << 20;                 // 一批组提交的字节上限
+        ReadMode readMode = ReadMode::Pread;              // 未命中缓存时的读取方式
+        MmapAdvice mmapAdvice = MmapAdvice::Random;       // mmap模式的访问模式提示
+        bool directIO = false;                            // 日志段使用O_DIRECT读写，不能与mmap模式同时使用
+        AsyncIO::Backend ioBackend = AsyncIO::Backend::Auto;  // 异步接口的I/O后端，首次使用时创建
+        unsigned ioQueueDepth = 128;                      // 同时在途的异步请求上限
+        unsigned ioThreads = 4;                           // 线程池后端的线程数
+        bool backgroundCompaction = true;                 // 后台线程按失效比例自动压缩
+        double compactionRatio = 0.5;                     // 封存段的失效字节占比达到该值时压缩该段
+        uint64_t compactionMinBytes = 64ull << 20;        // 全部失效字节少于该值时后台不压缩
+        uint64_t compactionRateLimit = 64ull << 20;       // 压缩读写限速(字节/秒)，0为不限速
+    };
+
+    // 数据文件空间占用
+    struct SpaceStats {
+        uint64_t fileBytes;     // 全部日志段的大小
+        uint64_t liveBytes;     // 存活记录(含记录头)的字节数
+        uint64_t compactions;   // 已压缩的段数
+        size_t segments;        // 日志段个数
+    };
+
+    // 组提交统计
+    struct WriteStats {
+        uint64_t batches;       // 写出的批次数
+        uint64_t records;       // 写出的记录数
+        uint64_t syncs;         // 刷盘次数
+    };
+
+    // 构造函数和析构函数，日志段为 filename + ".NNNNNN"，索引文件为 filename + ".idx"
+    // cacheBytes为缓存的字节预算；旧版本的单个数据文件 filename 在打开时转为第一个段
+    ObjectStorage(const std::string& filename, size_t cacheBytes,
+                  CachePolicy cachePolicy = CachePolicy::LRU);
+
+    ObjectStorage(const std::string& filename, const Options& options);
+
+    ~ObjectStorage() override;
+
+    // 插入对象，const引用版本复制一份数据
+    void put(int key, const std::vector<char>& value) override;
+
+    // 插入对象并接管所有权，数据不做任何复制，同一份缓冲区用于写日志和缓存
+    void put(int key, std::vector<char>&& value);
+    void put(int key, ValueRef value);
+
+    // 获取对象(复制一份数据)
+    std::vector<char> get(int key) override;
+
+    // 获取对象的只读句柄，缓存命中时不分配内存也不复制数据；对象不存在时返回空句柄
+    ValueRef getRef(int key);
+
+    // 批量获取，结果与keys一一对应，不存在的对象为空句柄
+    // 缓存和元数据的每个分片只加一次锁；未命中的对象按(段, 偏移)排序，相邻记录合并为一次preadv
+    std::vector<ValueRef> multiGet(const std::vector<int>& keys);
+
+    // 按key递增的顺序访问[start, end)中的对象，fn返回false时停止，返回访问的对象数
+    // 每次取出一批位置，按(段, 偏移)合并读取；回调处理当前一批时，下一批的数据已提交预读
+    // 扫描不是快照，期间的写入可能看到也可能看不到；读到的对象不放入缓存，避免大范围扫描冲掉热点
+    using ScanCallback = std::function<bool(int key, const ValueRef& value)>;
+    size_t scan(int start, int end, const ScanCallback& fn);
+
+    // 批量插入，全部请求一次进入写队列，通常作为一批写出；同一key按出现顺序覆盖
+    void multiPut(const std::vector<std::pair<int, ValueRef>>& items);
+
+    // 异步回调，在I/O完成线程或写出该批的线程上执行，不应长时间阻塞
+    using GetCallback = std::function<void(ValueRef value, std::exception_ptr error)>;
+    using PutCallback = std::function<void(std::exception_ptr error)>;
+
+    // 异步获取对象，缓存命中时直接在调用线程回调
+    void getAsync(int key, GetCallback callback);
+    std::future<ValueRef> getAsync(int key);
+
+    // 异步插入对象，数据写入日志并更新元数据后回调
+    void putAsync(int key, ValueRef value, PutCallback callback);
+    std::future<void> putAsync(int key, ValueRef value);
+
+    // 异步接口实际使用的I/O后端名称
+    const char* ioBackendName() { return asyncIO().name(); }
+
+    // 删除对象：追加墓碑记录，释放缓存中的条目，并把key记入负查找缓存
+    void del(int key) override;
+
+    // 把已写入的数据刷到磁盘
+    void flush() override;
+
+    // 用当前存活的元数据重写索引文件，清除被覆盖和删除的记录
+    void checkpoint();
+
+    // 压缩所有失效比例达到compactionRatio的封存段，回收被覆盖和删除的空间
+    // 扫描按compactionRateLimit限速，不阻塞读写；返回是否压缩了至少一个段
+    bool compact();
+
+    // 压缩指定的封存段，段不存在或是活动段时返回false
+    bool compactSegment(uint32_t segment);
+
+    // 调整压缩限速(字节/秒)，0为不限速，对下一次压缩生效
+    void setCompactionRateLimit(uint64_t bytesPerSecond);
+
+    // 当前可访问的对象数
+    size_t size() const override;
+
+    const char* name() const override { return "ObjectStorage"; }
+
+    SpaceStats spaceStats();
+
+    WriteStats writeStats();
+
+    // 缓存统计，包括常驻字节数
+    LRUCache::Stats cacheStats() { return cache.stats(); }
+
+    // 负查找缓存统计
+    NegativeCache::Stats negativeCacheStats() const { return negative.stats(); }
+
+    // Bloom过滤器占用的字节
+    size_t filterBytes() const;
+
+    // 元数据索引占用的字节
+    size_t indexBytes() const;
+
+    // 调试用，打印缓存内容
+    void printCache();
+
+    // 存储占用的全部文件(日志段和索引)，用于清理和基准测试
+    static std::vector<std::string> storageFiles(const std::string& filename);
+
+    // 删除存储的全部文件
+    static void destroy(const std::string& filename);
+
+private:
+    // 日志段的一个只读映射，由返回给调用方的ValueRef共同持有，最后一个持有者释放时解除映射
+    struct Mapping {
+        const char* addr;
+        size_t len;
+        Mapping(const char* addr, size_t len) : addr(addr), len(len) {}
+        ~Mapping();
+    };
+
+    // 日志段，读者通过shared_ptr持有，段被压缩删除后在最后一个持有者释放时关闭
+    struct Segment {
+        uint32_t id;
+        std::string path;
+        int fd;              // 只读描述符，只用pread；directIO模式下带O_DIRECT
+        uint64_t bytes;      // 已写入的字节，受writeMutex保护
+        uint64_t liveBytes;  // 存活记录的字节，受writeMutex保护
+        std::shared_ptr<const Mapping> mapping;  // mmap模式的当前映射，用atomic_load/atomic_store访问
+        std::mutex mapMutex;                     // 串行化重新映射
+        Segment(uint32_t id, const std::string& path, bool direct);
+        ~Segment();
+    };
+
+    // 写队列中的一个请求，value由请求持有，写日志和放入缓存都不复制
+    struct WriteRequest {
+        uint8_t flags;       // datalog::FLAG_PUT / FLAG_TOMBSTONE
+        int key;
+        ValueRef value;
+        bool done;
+        std::exception_ptr error;
+        PutCallback onDone;  // 异步请求的回调，同步请求为空
+    };
+
+    // 元数据分片，读者持有共享锁，写者持有独占锁
+    // 过滤器覆盖分片中的全部key(可能多出已删除的key)，查找先查过滤器，排除的key不再查表
+    struct MetadataShard {
+        mutable std::shared_mutex mutex;
+        MetadataIndex map;      // 哈希索引每个key一个8字节的紧凑位置，有序索引为B+树
+        BloomFilter filter;
+        size_t filterAdds = 0;  // 过滤器中已加入的key数，超过容量时按当前key数重建
+    };
+
+    // 每个分片的过滤器至少按这么多key分配
+    static const size_t kMinFilterKeys = 1024;
+
+    static const size_t kMetadataShards = 64;
+
+    static size_t metadataShardIndex(int key) {
+        return hashKey(key) & (kMetadataShards - 1);
+    }
+
+    MetadataShard& metadataShard(int key) {
+        return metadataMap[metadataShardIndex(key)];
+    }
+
+    // 批量读取中未命中缓存的一个对象
+    struct PendingRead {
+        size_t slot;                     // 在结果中的下标
+        int key;
+        Location entry;
+        std::shared_ptr<Segment> file;
+        ValueRef data;
+    };
+
+    // 合并读取：间隔不超过kCoalesceGap的相邻记录合并为一次preadv，一次跨度不超过kCoalesceSpan
+    static const uint64_t kCoalesceGap = 4096;
+    static const uint64_t kCoalesceSpan = 1 << 20;
+
+    // O_DIRECT的块大小，读写的偏移、长度和缓冲区地址都按它对齐
+    static const size_t kDirectBlock = 4096;
+    // directIO模式下追加写暂存区的大小，一批写入超过它时分多次写
+    static const size_t kDirectStageBytes = 1 << 20;
+
+    static std::string segmentPath(const std::string& filename, uint32_t id);
+    // 按编号列出已存在的日志段
+    static std::map<uint32_t, std::string> listSegments(const std::string& filename);
+
+    // 打开时恢复metadataMap：先回放索引文件，再扫描索引之后的日志尾部
+    void recover();
+
+    // 读者按编号查找日志段，段已删除时返回空
+    std::shared_ptr<Segment> findSegment(uint32_t id);
+
+    // 查找对象的位置和所在段，不存在时返回false
+    bool locate(int key, Location& entry, std::shared_ptr<Segment>& file);
+
+    // 读盘期间位置未变时把读到的数据放入缓存
+    void fillCache(int key, const Location& entry, const ValueRef& data);
+
+    // 按(段, 偏移)的顺序合并读取，填充每个reads[i].data
+    void readCoalesced(std::vector<PendingRead>& reads);
+
+    // 扫描中每个元数据分片一次取出的位置数，也是一批读取的对象数
+    static const size_t kScanBatch = 256;
+
+    // 读取扫描的一批对象：段已被压缩删除的对象按key重新查找
+    void readScanBatch(std::vector<PendingRead>& reads);
+    // 按(段, 偏移)合并相邻的范围，提示内核预读
+    void prefetch(const std::vector<PendingRead>& reads);
+
+    // 把[begin, end)所在的整块读入对齐缓冲区，返回的缓冲区从begin向下取整的块起点开始
+    AlignedBufferPool::Buffer readBlocks(const Segment& file, uint64_t begin, uint64_t end);
+    // directIO模式下读取一个对象
+    ValueRef readDirect(const Segment& file, uint64_t offset, uint32_t size);
+
+    // 异步I/O后端，首次使用时按options创建
+    AsyncIO& asyncIO();
+
+    // 返回至少覆盖到end的段映射，映射不够长(活动段增长超出预留长度)时重新映射
+    std::shared_ptr<const Mapping> mapSegment(Segment& seg, uint64_t end);
+
+    // 封存活动段并切换到新段，调用方需持有writeMutex
+    void rollSegment();
+
+    // 把一组写请求加入队列并等待全部完成，成为队首时负责写出整批请求
+    void submit(WriteRequest* reqs, size_t count);
+    // 作为领导者写出队首的一批请求并通知完成，调用方持有queueMutex
+    void lead(std::unique_lock<std::mutex>& lock);
+    // 异步写请求位于队首时代为写出
+    void commitLoop();
+    // 写出一批请求并更新元数据和缓存
+    void writeBatch(const std::vector<WriteRequest*>& batch);
+    // 从offset开始写出一组iovec，超过IOV_MAX时分多次写；offset必须是活动段的末尾
+    void writeVectors(std::vector<struct iovec>& iov, uint64_t offset);
+    // directIO模式的追加写：拼接到暂存区后整块写出
+    void writeDirect(const std::vector<struct iovec>& iov, uint64_t offset);
+    // 以追加写方式打开活动段，bytes为段的大小，directIO模式下据此加载未写满的末块
+    void openActive(const std::string& path, int flags, uint64_t bytes);
+    // 按刷盘策略在一批写入后刷盘，调用方需持有writeMutex
+    void syncAfterBatch();
+
+    // Interval策略的后台刷盘线程
+    void syncLoop();
+
+    // 后台压缩线程
+    void compactionLoop();
+    bool needsCompaction();
+    // 失效比例达到阈值的封存段，按失效字节从多到少排列，调用方需持有writeMutex
+    std::vector<uint32_t> compactionCandidates();
+
+    // 把封存段中存活的记录重新追加到活动段后删除该段，调用方需持有compactMutex
+    bool relocateSegment(uint32_t id);
+
+    // 记录在日志中占用的字节(含记录头)
+    static uint64_t recordBytes(uint32_t size);
+
+    // 用metadataMap重写索引文件，同时重建过滤器并与索引一起保存
+    void rewriteIndex();
+
+    // 把新写入的key加入分片的过滤器，调用方持有分片的独占锁且key已在map中
+    void filterAdd(MetadataShard& shard, int key);
+    // 按分片当前的key重建过滤器，容量留出一倍余量
+    void rebuildFilter(MetadataShard& shard);
+
+    // 过滤器文件与索引快照对应，记录重写索引时的日志末尾和快照的记录数
+    struct SavedFilters {
+        uint32_t dataSegment;
+        uint64_t dataEnd;
+        uint64_t records;
+        std::vector<BloomFilter> filters;   // 每个元数据分片一个
+        std::vector<uint64_t> adds;
+    };
+    void saveFilters(uint32_t dataSegment, uint64_t dataEnd, size_t records);
+    // 读入过滤器文件，文件不存在、损坏或参数不同时返回false；是否与索引一致由调用方判断
+    bool readFilters(SavedFilters& saved);
+
+    // 恢复时逐条追加到索引的记录上限，超过则整体重写索引
+    static const size_t kMaxIndexAppend = 4096;
+
+    Options options;
+    std::string dataPath;
+    // 全部日志段，增删时同时持有writeMutex和segmentsMutex，读者只持有共享锁
+    std::map<uint32_t, std::shared_ptr<Segment>> segments;
+    std::shared_mutex segmentsMutex;
+    std::shared_ptr<Segment> active;  // 活动段，受writeMutex保护
+    int writeFd;                 // 活动段的追加写描述符
+    AlignedBufferPool directBuffers;      // directIO模式的读缓冲区
+    AlignedBufferPool::Buffer directStage;  // directIO模式的写暂存区，开头是末块已写入的部分，受writeMutex保护
+    size_t stageFill;            // 暂存区中末块已写入的字节，等于活动段大小除以块大小的余数
+    uint64_t compactions;        // 受writeMutex保护
+    WriteStats writes;           // 受writeMutex保护
+    bool dirty;                  // 有未刷盘的写入，受writeMutex保护
+    std::chrono::steady_clock::time_point lastSync;  // 受writeMutex保护
+    std::mutex writeMutex;       // 串行化追加写和索引文件
+
+    std::mutex queueMutex;       // 保护写队列
+    std::condition_variable queueCv;
+    std::deque<WriteRequest*> writeQueue;
+    bool commitStopping;         // 受queueMutex保护
+    std::once_flag commitOnce;
+    std::thread commitThread;    // 首次异步写时启动
+
+    std::once_flag ioOnce;
+    std::unique_ptr<AsyncIO> io;
+
+    std::array<MetadataShard, kMetadataShards> metadataMap;
+    IndexFile index;
+    LRUCache cache;
+    NegativeCache negative;   // 已知不存在的key
+
+    std::mutex compactMutex;     // 同一时间只允许一个压缩
+    std::mutex backgroundMutex;  // 后台线程的等待和退出
+    std::condition_variable backgroundCv;
+    bool stopping;
+    std::thread compactionThread;
+    std::thread syncThread;
+};
+
+#endif // OBJECT_STORAGE_H
@@ -0,0 +1,331 @@
+#ifndef ORDERED_INDEX_H
+#define ORDERED_INDEX_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+#include "PackedIndex.h"
+
+// 有序索引(B+树)，接口与PackedIndex相同，另外支持按key范围遍历
+// 节点按缓存行组织：key和值分成两个数组，节点内查找只访问key数组(叶子64个int为4条缓存行)，
+// 命中后才读取值；叶子双向链接，范围遍历沿叶子链表顺序进行
+// 删除不做节点合并，叶子删空时从父节点摘除，未满的节点保留；按递增顺序插入时叶子不对半分裂，保持满载
+template <typename Key>
+class OrderedIndex {
+public:
+    static const size_t kLeafSlots = 64;
+    static const size_t kInnerSlots = 63;   // 分隔key数，子节点数多一个
+
+    OrderedIndex() : root(nullptr), height(0), count(0), leaves(0), inners(0) {}
+    ~OrderedIndex() { clear(); }
+
+    OrderedIndex(const OrderedIndex&) = delete;
+    OrderedIndex& operator=(const OrderedIndex&) = delete;
+
+    bool find(const Key& key, Location& loc) const {
+        if (root == nullptr) return false;
+        const Leaf* leaf = findLeaf(key);
+        size_t i = lowerBound(leaf->keys, leaf->count, key);
+        if (i == leaf->count || leaf->keys[i] != key) return false;
+        loc = unpack(leaf->values[i]);
+        return true;
+    }
+
+    bool contains(const Key& key) const {
+        Location loc;
+        return find(key, loc);
+    }
+
+    // 插入或覆盖
+    void assign(const Key& key, const Location& loc) {
+        if (root == nullptr) {
+            root = newLeaf();
+            height = 0;
+        }
+        Path path;
+        Leaf* leaf = descend(key, path);
+        size_t i = lowerBound(leaf->keys, leaf->count, key);
+        if (i < leaf->count && leaf->keys[i] == key) {
+            leaf->values[i] = pack(loc);
+            return;
+        }
+        ++count;
+        if (leaf->count < kLeafSlots) {
+            insertAt(leaf, i, key, pack(loc));
+            return;
+        }
+
+        // 叶子已满：分裂后把新叶子的第一个key插入父节点
+        // 追加到最右侧叶子的末尾时新叶子只放新key，顺序写入得到满载的叶子
+        Leaf* right = newLeaf();
+        size_t n = leaf->count;
+        size_t mid = (i == n && leaf->next == nullptr) ? n : n / 2;
+        right->count = static_cast<uint32_t>(n - mid);
+        std::copy(leaf->keys + mid, leaf->keys + n, right->keys);
+        std::copy(leaf->values + mid, leaf->values + n, right->values);
+        leaf->count = static_cast<uint32_t>(mid);
+        right->next = leaf->next;
+        right->prev = leaf;
+        if (leaf->next != nullptr) leaf->next->prev = right;
+        leaf->next = right;
+        if (i <= mid && mid < n) {
+            insertAt(leaf, i, key, pack(loc));
+        } else {
+            insertAt(right, i - mid, key, pack(loc));
+        }
+        insertSeparator(path, right->keys[0], right);
+    }
+
+    bool erase(const Key& key) {
+        if (root == nullptr) return false;
+        Path path;
+        Leaf* leaf = descend(key, path);
+        size_t i = lowerBound(leaf->keys, leaf->count, key);
+        if (i == leaf->count || leaf->keys[i] != key) return false;
+        std::copy(leaf->keys + i + 1, leaf->keys + leaf->count, leaf->keys + i);
+        std::copy(leaf->values + i + 1, leaf->values + leaf->count, leaf->values + i);
+        --leaf->count;
+        --count;
+        if (leaf->count == 0 && height > 0) removeLeaf(leaf, path);
+        return true;
+    }
+
+    // f(key, const Location&)，按key递增的顺序
+    template <typename F>
+    void forEach(F f) const {
+        for (const Leaf* leaf = firstLeaf(); leaf != nullptr; leaf = leaf->next) {
+            for (size_t i = 0; i < leaf->count; ++i) f(leaf->keys[i], unpack(leaf->values[i]));
+        }
+    }
+
+    // 按key递增的顺序访问[from, end)中的前limit个key，f(key, const Location&)，返回访问的个数
+    template <typename F>
+    size_t scan(const Key& from, const Key& end, size_t limit, F f) const {
+        if (root == nullptr || limit == 0) return 0;
+        const Leaf* leaf = findLeaf(from);
+        size_t i = lowerBound(leaf->keys, leaf->count, from);
+        size_t visited = 0;
+        for (; leaf != nullptr; leaf = leaf->next, i = 0) {
+            for (; i < leaf->count; ++i) {
+                if (!(leaf->keys[i] < end)) return visited;
+                f(leaf->keys[i], unpack(leaf->values[i]));
+                if (++visited == limit) return visited;
+            }
+        }
+        return visited;
+    }
+
+    // 节点按需分配，不需要预留
+    void reserve(size_t) {}
+
+    void clear() {
+        if (root != nullptr) release(root, height);
+        root = nullptr;
+        height = 0;
+        count = 0;
+    }
+
+    size_t size() const { return count; }
+    size_t memoryBytes() const { return leaves * sizeof(Leaf) + inners * sizeof(Inner); }
+
+private:
+    // 叶子中的位置，16字节，没有Location的对齐填充
+    struct Value {
+        uint64_t offset;
+        uint32_t segment;
+        uint32_t size;
+    };
+
+    struct alignas(64) Leaf {
+        Key keys[kLeafSlots];
+        uint32_t count = 0;
+        Leaf* prev = nullptr;
+        Leaf* next = nullptr;
+        Value values[kLeafSlots];
+    };
+
+    // children[i]中的key都小于keys[i]，children[i + 1]中的key都不小于keys[i]
+    struct alignas(64) Inner {
+        Key keys[kInnerSlots];
+        uint32_t count = 0;     // 分隔key数，子节点为count + 1个
+        void* children[kInnerSlots + 1];
+    };
+
+    // 根到叶子经过的内部节点和所选子节点的下标
+    struct Path {
+        Inner* nodes[32];
+        size_t slots[32];
+        size_t depth = 0;
+    };
+
+    static Value pack(const Location& loc) { return Value{loc.offset, loc.segment, loc.size}; }
+    static Location unpack(const Value& v) { return Location{v.segment, v.offset, v.size}; }
+
+    static size_t lowerBound(const Key* keys, size_t n, const Key& key) {
+        return static_cast<size_t>(std::lower_bound(keys, keys + n, key) - keys);
+    }
+
+    // 第一个大于key的分隔key的下标，即key所在子节点的下标
+    static size_t childIndex(const Inner* node, const Key& key) {
+        return static_cast<size_t>(std::upper_bound(node->keys, node->keys + node->count, key) - node->keys);
+    }
+
+    const Leaf* findLeaf(const Key& key) const {
+        const void* node = root;
+        for (unsigned level = height; level > 0; --level) {
+            const Inner* inner = static_cast<const Inner*>(node);
+            node = inner->children[childIndex(inner, key)];
+        }
+        return static_cast<const Leaf*>(node);
+    }
+
+    Leaf* descend(const Key& key, Path& path) {
+        void* node = root;
+        path.depth = 0;
+        for (unsigned level = height; level > 0; --level) {
+            Inner* inner = static_cast<Inner*>(node);
+            size_t c = childIndex(inner, key);
+            path.nodes[path.depth] = inner;
+            path.slots[path.depth] = c;
+            ++path.depth;
+            node = inner->children[c];
+        }
+        return static_cast<Leaf*>(node);
+    }
+
+    const Leaf* firstLeaf() const {
+        if (root == nullptr) return nullptr;
+        const void* node = root;
+        for (unsigned level = height; level > 0; --level) node = static_cast<const Inner*>(node)->children[0];
+        return static_cast<const Leaf*>(node);
+    }
+
+    static void insertAt(Leaf* leaf, size_t i, const Key& key, const Value& value) {
+        std::copy_backward(leaf->keys + i, leaf->keys + leaf->count, leaf->keys + leaf->count + 1);
+        std::copy_backward(leaf->values + i, leaf->values + leaf->count, leaf->values + leaf->count + 1);
+        leaf->keys[i] = key;
+        leaf->values[i] = value;
+        ++leaf->count;
+    }
+
+    // 把分裂出的右侧节点child及其分隔key插入路径上的父节点，父节点满时继续向上分裂
+    void insertSeparator(Path& path, Key separator, void* child) {
+        while (path.depth > 0) {
+            --path.depth;
+            Inner* node = path.nodes[path.depth];
+            size_t c = path.slots[path.depth];
+            if (node->count < kInnerSlots) {
+                insertChild(node, c, separator, child);
+                return;
+            }
+            // 先插入到临时数组再对半分，中间的key上移到父节点
+            Key keys[kInnerSlots + 1];
+            void* children[kInnerSlots + 2];
+            std::copy(node->keys, node->keys + c, keys);
+            keys[c] = separator;
+            std::copy(node->keys + c, node->keys + node->count, keys + c + 1);
+            std::copy(node->children, node->children + c + 1, children);
+            children[c + 1] = child;
+            std::copy(node->children + c + 1, node->children + node->count + 1, children + c + 2);
+
+            size_t total = kInnerSlots + 1;
+            size_t mid = total / 2;
+            Inner* right = newInner();
+            node->count = static_cast<uint32_t>(mid);
+            std::copy(keys, keys + mid, node->keys);
+            std::copy(children, children + mid + 1, node->children);
+            right->count = static_cast<uint32_t>(total - mid - 1);
+            std::copy(keys + mid + 1, keys + total, right->keys);
+            std::copy(children + mid + 1, children + total + 1, right->children);
+            separator = keys[mid];
+            child = right;
+        }
+        // 根节点分裂，树增高一层
+        Inner* top = newInner();
+        top->count = 1;
+        top->keys[0] = separator;
+        top->children[0] = root;
+        top->children[1] = child;
+        root = top;
+        ++height;
+    }
+
+    static void insertChild(Inner* node, size_t c, const Key& separator, void* child) {
+        std::copy_backward(node->keys + c, node->keys + node->count, node->keys + node->count + 1);
+        std::copy_backward(node->children + c + 1, node->children + node->count + 1,
+                           node->children + node->count + 2);
+        node->keys[c] = separator;
+        node->children[c + 1] = child;
+        ++node->count;
+    }
+
+    // 从父节点摘除删空的叶子，父节点没有子节点时继续向上摘除；根只剩一个子节点时降低一层
+    void removeLeaf(Leaf* leaf, Path& path) {
+        if (leaf->prev != nullptr) leaf->prev->next = leaf->next;
+        if (leaf->next != nullptr) leaf->next->prev = leaf->prev;
+        delete leaf;
+        --leaves;
+
+        while (path.depth > 0) {
+            --path.depth;
+            Inner* node = path.nodes[path.depth];
+            size_t c = path.slots[path.depth];
+            if (node->count > 0) {
+                // 摘除子节点c和一侧的分隔key
+                size_t k = c == 0 ? 0 : c - 1;
+                std::copy(node->keys + k + 1, node->keys + node->count, node->keys + k);
+                std::copy(node->children + c + 1, node->children + node->count + 1, node->children + c);
+                --node->count;
+                break;
+            }
+            // 唯一的子节点被摘除，节点本身也删空
+            if (node == root) {
+                delete node;
+                --inners;
+                root = newLeaf();
+                height = 0;
+                return;
+            }
+            delete node;
+            --inners;
+        }
+        while (height > 0 && static_cast<Inner*>(root)->count == 0) {
+            Inner* top = static_cast<Inner*>(root);
+            root = top->children[0];
+            delete top;
+            --inners;
+            --height;
+        }
+    }
+
+    Leaf* newLeaf() {
+        ++leaves;
+        return new Leaf();
+    }
+
+    Inner* newInner() {
+        ++inners;
+        return new Inner();
+    }
+
+    void release(void* node, unsigned level) {
+        if (level == 0) {
+            delete static_cast<Leaf*>(node);
+            --leaves;
+            return;
+        }
+        Inner* inner = static_cast<Inner*>(node);
+        for (size_t i = 0; i <= inner->count; ++i) release(inner->children[i], level - 1);
+        delete inner;
+        --inners;
+    }
+
+    void* root;          // height为0时是叶子
+    unsigned height;     // 内部节点的层数
+    size_t count;
+    size_t leaves;
+    size_t inners;
+};
+
+#endif // ORDERED_INDEX_H
@@ -0,0 +1,126 @@
+#ifndef PACKED_INDEX_H
+#define PACKED_INDEX_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "FlatHashMap.h"
+
+// 对象在日志中的位置
+struct Location {
+    uint32_t segment;    // 所在日志段(或引擎自定义的区域号)
+    uint64_t offset;     // 段内偏移量(value起始位置)
+    uint32_t size;       // 对象大小
+};
+
+// 8字节的紧凑位置：低kSizeBits位是大小，其上offsetBits位是段内偏移，最高的剩余位是段号
+// 拆成两个uint32_t使其只需4字节对齐，和int key组成的槽只占12字节，和16字节的key组成的槽占24字节
+struct PackedLocation {
+    uint32_t lo;
+    uint32_t hi;
+};
+
+// 以紧凑位置为值的索引，key本身只存在表的槽里
+// 任一字段超出位宽的位置(大对象、过大的偏移或段号)原样存放在溢出表中，
+// 紧凑值的大小字段记为kOverflow；常见的小对象只占主表的一个槽
+template <typename Key, typename Hash = FlatHash>
+class PackedIndex {
+public:
+    static const unsigned kSizeBits = 20;
+    static const uint32_t kOverflow = (1u << kSizeBits) - 1;   // 不小于它的大小都走溢出表
+
+    // offsetBits为偏移的位宽，段号占其余的64-kSizeBits-offsetBits位(至少1位)
+    explicit PackedIndex(unsigned offsetBits = 32) { setOffsetBits(offsetBits); }
+
+    PackedIndex(const PackedIndex&) = delete;
+    PackedIndex& operator=(const PackedIndex&) = delete;
+
+    // 容纳不超过maxOffset的偏移需要的位宽，至少给段号留minSegmentBits位
+    static unsigned offsetBitsFor(uint64_t maxOffset, unsigned minSegmentBits) {
+        unsigned bits = 1;
+        while (bits < 64 && (maxOffset >> bits) != 0) ++bits;
+        unsigned limit = 64 - kSizeBits - minSegmentBits;
+        return bits < limit ? bits : limit;
+    }
+
+    // 修改偏移的位宽，只能在索引为空时调用
+    void setOffsetBits(unsigned bits) {
+        offsetBits = bits;
+        segmentBits = 64 - kSizeBits - bits;
+    }
+
+    bool find(const Key& key, Location& loc) const {
+        auto it = map.find(key);
+        if (it == map.end()) return false;
+        loc = unpack(key, it->second);
+        return true;
+    }
+
+    bool contains(const Key& key) const { return map.find(key) != map.end(); }
+
+    // 插入或覆盖
+    void assign(const Key& key, const Location& loc) {
+        PackedLocation p;
+        bool fits = pack(loc, p);
+        auto r = map.emplace(key, p);
+        if (!r.second) {
+            if (isOverflow(r.first->second) && fits) overflow.erase(key);
+            r.first->second = p;
+        }
+        // 用表中已有的key，参数可能只是调用方字符串的视图
+        if (!fits) overflow[r.first->first] = loc;
+    }
+
+    bool erase(const Key& key) {
+        auto it = map.find(key);
+        if (it == map.end()) return false;
+        if (isOverflow(it->second)) overflow.erase(key);
+        map.erase(it);
+        return true;
+    }
+
+    // f(key, const Location&)
+    template <typename F>
+    void forEach(F f) const {
+        for (const auto& kv : map) f(kv.first, unpack(kv.first, kv.second));
+    }
+
+    void reserve(size_t n) { map.reserve(n); }
+
+    size_t size() const { return map.size(); }
+    size_t overflowSize() const { return overflow.size(); }
+    size_t memoryBytes() const { return map.memoryBytes() + overflow.memoryBytes(); }
+
+private:
+    static bool isOverflow(PackedLocation p) { return (p.lo & kOverflow) == kOverflow; }
+
+    bool pack(const Location& loc, PackedLocation& p) const {
+        uint64_t v = kOverflow;
+        bool fits = loc.size < kOverflow && (loc.offset >> offsetBits) == 0
+            && (segmentBits >= 32 || (static_cast<uint64_t>(loc.segment) >> segmentBits) == 0);
+        if (fits) {
+            v = loc.size | (loc.offset << kSizeBits)
+                | (static_cast<uint64_t>(loc.segment) << (kSizeBits + offsetBits));
+        }
+        p.lo = static_cast<uint32_t>(v);
+        p.hi = static_cast<uint32_t>(v >> 32);
+        return fits;
+    }
+
+    Location unpack(const Key& key, PackedLocation p) const {
+        if (isOverflow(p)) return overflow.find(key)->second;
+        uint64_t v = p.lo | static_cast<uint64_t>(p.hi) << 32;
+        Location loc;
+        loc.size = static_cast<uint32_t>(v & kOverflow);
+        loc.offset = (v >> kSizeBits) & ((1ull << offsetBits) - 1);
+        loc.segment = static_cast<uint32_t>(v >> (kSizeBits + offsetBits));
+        return loc;
+    }
+
+    unsigned offsetBits;
+    unsigned segmentBits;
+    FlatHashMap<Key, PackedLocation, Hash> map;
+    FlatHashMap<Key, Location, Hash> overflow;
+};
+
+#endif // PACKED_INDEX_H
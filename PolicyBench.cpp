@@ -0,0 +1,85 @@
+#include "LRUCache.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <random>
+
+// 淘汰策略测试：回放访问序列，输出各策略的命中率和吞吐
+// 默认生成Zipf热点访问，并周期性穿插全键空间扫描(模拟夜间全量扫描)
+// 用法: PolicyBench [缓存条目数] [trace文件(每行一个key)]
+
+static std::vector<int> syntheticTrace() {
+    const int hotKeys = 100000;
+    const int scanKeys = 1000000;
+    const size_t rounds = 4;
+    const size_t hotOps = 1000000;
+
+    // Zipf(0.99) 累积分布
+    std::vector<double> cdf(hotKeys);
+    double sum = 0;
+    for (int i = 0; i < hotKeys; ++i) {
+        sum += 1.0 / std::pow(i + 1, 0.99);
+        cdf[i] = sum;
+    }
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<double> dist(0, sum);
+
+    std::vector<int> trace;
+    trace.reserve(rounds * (hotOps + scanKeys));
+    for (size_t r = 0; r < rounds; ++r) {
+        for (size_t i = 0; i < hotOps; ++i) {
+            int rank = static_cast<int>(std::lower_bound(cdf.begin(), cdf.end(), dist(rng)) - cdf.begin());
+            trace.push_back(rank);
+        }
+        // 扫描使用热点集合之外的key，每个只访问一次
+        for (int k = 0; k < scanKeys; ++k) {
+            trace.push_back(hotKeys + k);
+        }
+    }
+    return trace;
+}
+
+// 文件无法打开或没有读到任何key时返回false
+static bool loadTrace(const char* path, std::vector<int>& trace) {
+    std::ifstream in(path);
+    if (!in.is_open()) return false;
+    int key;
+    while (in >> key) trace.push_back(key);
+    return !trace.empty();
+}
+
+int main(int argc, char* argv[]) {
+    size_t entries = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 10000;
+    std::vector<int> trace;
+    if (argc > 2) {
+        if (!loadTrace(argv[2], trace)) {
+            std::cerr << "cannot read trace or trace is empty: " << argv[2] << std::endl;
+            return 1;
+        }
+    } else {
+        trace = syntheticTrace();
+    }
+    const size_t valueSize = 64;
+    std::cout << "trace: " << trace.size() << " accesses, cache: " << entries << " entries" << std::endl;
+
+    ValueRef value = ValueRef::copyOf(std::string(valueSize, 'v').data(), valueSize);
+    for (CachePolicy policy : {CachePolicy::LRU, CachePolicy::SLRU, CachePolicy::TinyLFU}) {
+        // 单分片，排除分片对命中率的影响
+        LRUCache cache(entries * LRUCache::charge(valueSize), 1, policy);
+        auto start = std::chrono::steady_clock::now();
+        for (int key : trace) {
+            if (!cache.get(key)) {
+                cache.put(key, value);
+            }
+        }
+        double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        LRUCache::Stats stats = cache.stats();
+        std::cout << cachePolicyName(policy) << ": hit ratio "
+                  << static_cast<double>(stats.hits) / (stats.hits + stats.misses)
+                  << ", " << trace.size() / sec / 1e6 << " Mops/s" << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,31 @@
+#ifndef RATE_LIMITER_H
+#define RATE_LIMITER_H
+
+#include <chrono>
+#include <thread>
+#include <cstdint>
+
+// 按字节限速：根据累计字节数计算应耗的时间，超前时睡眠等待
+class RateLimiter {
+public:
+    // bytesPerSecond为0时不限速
+    explicit RateLimiter(uint64_t bytesPerSecond)
+        : rate(bytesPerSecond), total(0), start(std::chrono::steady_clock::now()) {}
+
+    void acquire(uint64_t bytes) {
+        if (rate == 0) return;
+        total += bytes;
+        auto expected = start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+            std::chrono::duration<double>(static_cast<double>(total) / rate));
+        if (std::chrono::steady_clock::now() < expected) {
+            std::this_thread::sleep_until(expected);
+        }
+    }
+
+private:
+    uint64_t rate;
+    uint64_t total;
+    std::chrono::steady_clock::time_point start;
+};
+
+#endif // RATE_LIMITER_H
@@ -0,0 +1,77 @@
+#include "ObjectStorage.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+
+// 范围扫描测试：元数据使用哈希索引和有序索引(B+树)时的对比
+// 按随机顺序写入key，关闭缓存，测量点查耗时、索引每个key的内存，以及不同范围长度的扫描吞吐(对象/秒)
+// 哈希索引的scan需要遍历全部key，短范围扫描的次数按时间限制
+// 用法: ScanBench [key数量] [对象大小] [点查次数]
+
+static double seconds(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+static void run(bool ordered, int keys, size_t valueSize, size_t lookups) {
+    const std::string path = "scan_bench.dat";
+    ObjectStorage::destroy(path);
+    ObjectStorage::Options o;
+    o.orderedIndex = ordered;
+    o.cacheBytes = 0;
+    o.backgroundCompaction = false;
+    {
+        ObjectStorage store(path, o);
+        std::vector<int> order(keys);
+        for (int i = 0; i < keys; ++i) order[i] = i;
+        std::shuffle(order.begin(), order.end(), std::mt19937(3));
+        std::vector<std::pair<int, ValueRef>> batch;
+        std::vector<char> value(valueSize, 's');
+        for (size_t i = 0; i < order.size(); ++i) {
+            batch.emplace_back(order[i], ValueRef::copyOf(value.data(), value.size()));
+            if (batch.size() == 4096 || i + 1 == order.size()) {
+                store.multiPut(batch);
+                batch.clear();
+            }
+        }
+        store.flush();
+
+        std::mt19937 rng(7);
+        std::uniform_int_distribution<int> pick(0, keys - 1);
+        size_t found = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < lookups; ++i) found += static_cast<bool>(store.getRef(pick(rng)));
+        double pointNs = seconds(start) * 1e9 / lookups;
+
+        std::printf("%s %.1f %.1f", ordered ? "ordered" : "hash",
+                    static_cast<double>(store.indexBytes()) / keys, pointNs);
+        for (int range : {100, 10000, keys}) {
+            size_t objects = 0;
+            size_t scans = 0;
+            start = std::chrono::steady_clock::now();
+            // 至少扫描一次，之后最多持续1秒
+            do {
+                int from = range >= keys ? 0 : pick(rng) % (keys - range);
+                objects += store.scan(from, from + range, [](int, const ValueRef&) { return true; });
+                ++scans;
+            } while (seconds(start) < 1.0 && range < keys);
+            std::printf(" %.0f", objects / seconds(start));
+            if (objects != scans * static_cast<size_t>(range)) std::printf("(unexpected)");
+        }
+        std::printf("%s\n", found != lookups ? " (missing)" : "");
+    }
+    ObjectStorage::destroy(path);
+}
+
+int main(int argc, char* argv[]) {
+    int keys = argc > 1 ? std::atoi(argv[1]) : 1000000;
+    size_t valueSize = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 100;
+    size_t lookups = argc > 3 ? std::strtoull(argv[3], nullptr, 10) : 1000000;
+
+    std::printf("index bytes/key point_ns scan100_obj/s scan10000_obj/s full_scan_obj/s\n");
+    run(false, keys, valueSize, lookups);
+    run(true, keys, valueSize, lookups);
+    return 0;
+}
@@ -0,0 +1,189 @@
+#ifndef SLAB_ALLOCATOR_H
+#define SLAB_ALLOCATOR_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <utility>
+
+// 小对象的slab分配器：按大小分级，每级从64KB的arena中顺序切出固定大小的槽，
+// 释放的槽挂到该级的空闲链表上复用；超过最大级别的请求直接走operator new
+// arena不归还系统，占用上限由缓存容量决定；每级一把锁，不同大小的分配互不阻塞
+class SlabArena {
+public:
+    static const size_t kMaxSlot = 2048;          // 最大的槽，更大的请求不走slab
+    static const size_t kArenaBytes = 64 << 10;   // 每次向系统申请的arena大小
+
+    struct Stats {
+        size_t arenaBytes;     // 已申请的arena总字节
+        size_t slotsInUse;     // 正在使用的槽数
+        size_t bytesInUse;     // 正在使用的槽的总字节(按槽大小计)
+    };
+
+    // 进程内唯一的实例，故意不析构，静态对象析构期间释放的句柄仍然安全
+    static SlabArena& instance() {
+        static SlabArena* arena = new SlabArena;
+        return *arena;
+    }
+
+    void* allocate(size_t bytes) {
+        if (bytes > kMaxSlot) return ::operator new(bytes);
+        SizeClass& c = classes[classOf(bytes)];
+        std::lock_guard<std::mutex> lock(c.mutex);
+        ++c.inUse;
+        if (c.freeList) {
+            FreeSlot* slot = c.freeList;
+            c.freeList = slot->next;
+            return slot;
+        }
+        if (c.cursor + c.slot > c.limit) {
+            c.cursor = static_cast<char*>(::operator new(kArenaBytes));
+            c.limit = c.cursor + kArenaBytes;
+            ++c.arenas;
+        }
+        void* p = c.cursor;
+        c.cursor += c.slot;
+        return p;
+    }
+
+    // bytes必须与分配时相同
+    void deallocate(void* p, size_t bytes) {
+        if (!p) return;
+        if (bytes > kMaxSlot) {
+            ::operator delete(p);
+            return;
+        }
+        SizeClass& c = classes[classOf(bytes)];
+        std::lock_guard<std::mutex> lock(c.mutex);
+        --c.inUse;
+        FreeSlot* slot = static_cast<FreeSlot*>(p);
+        slot->next = c.freeList;
+        c.freeList = slot;
+    }
+
+    // 128字节以内按16字节分级，之后每翻一倍分8级，相邻级别的浪费不超过12.5%
+    static constexpr size_t kClasses = 40;
+    static constexpr size_t kSlotSizes[kClasses] = {
+        16, 32, 48, 64, 80, 96, 112, 128, 144, 160, 176, 192, 208, 224, 240, 256,
+        288, 320, 352, 384, 416, 448, 480, 512,
+        576, 640, 704, 768, 832, 896, 960, 1024,
+        1152, 1280, 1408, 1536, 1664, 1792, 1920, 2048,
+    };
+
+    // 容纳bytes字节的最小级别，bytes不超过kMaxSlot
+    static size_t classOf(size_t bytes) { return instance().lookup[index(bytes)]; }
+
+    // 请求bytes字节时实际占用的槽大小
+    static size_t slotSize(size_t bytes) {
+        return bytes > kMaxSlot ? bytes : kSlotSizes[classOf(bytes)];
+    }
+
+    Stats stats() {
+        Stats s = {0, 0, 0};
+        for (SizeClass& c : classes) {
+            std::lock_guard<std::mutex> lock(c.mutex);
+            s.arenaBytes += c.arenas * kArenaBytes;
+            s.slotsInUse += c.inUse;
+            s.bytesInUse += c.inUse * c.slot;
+        }
+        return s;
+    }
+
+private:
+    struct FreeSlot {
+        FreeSlot* next;
+    };
+
+    struct SizeClass {
+        size_t slot = 0;
+        std::mutex mutex;
+        FreeSlot* freeList = nullptr;
+        char* cursor = nullptr;   // 当前arena中下一个未切分的位置
+        char* limit = nullptr;
+        size_t inUse = 0;
+        size_t arenas = 0;
+    };
+
+    // 按16字节取整后的下标，查表得到级别
+    static size_t index(size_t bytes) { return bytes == 0 ? 0 : (bytes - 1) / 16; }
+
+    SlabArena() {
+        size_t c = 0;
+        for (size_t i = 0; i < lookup.size(); ++i) {
+            while (kSlotSizes[c] < (i + 1) * 16) ++c;
+            lookup[i] = static_cast<uint8_t>(c);
+        }
+        for (size_t i = 0; i < kClasses; ++i) classes[i].slot = kSlotSizes[i];
+    }
+
+    std::array<uint8_t, kMaxSlot / 16> lookup;
+    std::array<SizeClass, kClasses> classes;
+};
+
+// 使用SlabArena的STL分配器，用于缓存的哈希表节点和队列节点
+template <typename T>
+class SlabAllocator {
+public:
+    using value_type = T;
+    static_assert(alignof(T) <= 16, "slab槽只保证16字节对齐");
+
+    SlabAllocator() noexcept {}
+    template <typename U>
+    SlabAllocator(const SlabAllocator<U>&) noexcept {}
+
+    T* allocate(size_t n) { return static_cast<T*>(SlabArena::instance().allocate(n * sizeof(T))); }
+    void deallocate(T* p, size_t n) noexcept { SlabArena::instance().deallocate(p, n * sizeof(T)); }
+
+    template <typename U>
+    bool operator==(const SlabAllocator<U>&) const noexcept { return true; }
+    template <typename U>
+    bool operator!=(const SlabAllocator<U>&) const noexcept { return false; }
+};
+
+namespace slab_detail {
+
+// shared_ptr控制块(虚表指针和两个计数)的大小，allocate_shared把它和负载放在同一个槽里
+constexpr size_t kControlBytes = 2 * sizeof(void*);
+// 负载分级和槽分级一一对应：第I级负载加上控制块正好占满第I+1级的槽
+constexpr size_t kPayloadClasses = 31;
+static_assert(SlabArena::kSlotSizes[kPayloadClasses] == 1024, "负载分级覆盖到1024字节的槽");
+
+template <size_t N>
+struct Payload {
+    char bytes[N];
+};
+
+using Maker = std::shared_ptr<const void> (*)(char**);
+
+template <size_t I>
+std::shared_ptr<const void> make(char** out) {
+    using P = Payload<SlabArena::kSlotSizes[I + 1] - kControlBytes>;
+    std::shared_ptr<P> p = std::allocate_shared<P>(SlabAllocator<P>());
+    *out = p->bytes;
+    return p;
+}
+
+template <size_t... I>
+constexpr std::array<Maker, sizeof...(I)> makers(std::index_sequence<I...>) {
+    return {{&make<I>...}};
+}
+
+} // namespace slab_detail
+
+// 不超过kMaxSlabPayload字节的缓冲区：一次slab分配同时容纳引用计数和负载
+// 通过out返回可写指针；size超过上限时返回空
+constexpr size_t kMaxSlabPayload = 1024 - slab_detail::kControlBytes;
+
+inline std::shared_ptr<const void> slabShared(size_t size, char** out) {
+    static constexpr std::array<slab_detail::Maker, slab_detail::kPayloadClasses> table =
+        slab_detail::makers(std::make_index_sequence<slab_detail::kPayloadClasses>());
+    if (size > kMaxSlabPayload) return nullptr;
+    // 加上控制块后所在的槽级别，最小为第1级(32字节)
+    size_t c = SlabArena::classOf(size + slab_detail::kControlBytes);
+    return table[c == 0 ? 0 : c - 1](out);
+}
+
+#endif // SLAB_ALLOCATOR_H
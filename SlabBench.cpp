@@ -0,0 +1,80 @@
+#include "LRUCache.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// slab分配器测试：缓存中放入大量小对象，比较负载用独立vector(fromVector)和slab(copyOf)时
+// 每个对象的常驻内存(RSS增量)、每次put的堆分配次数和put吞吐
+// 每种组合在单独的子进程中运行，避免前一轮释放的内存影响RSS
+// 用法: SlabBench [对象数量]
+
+static std::atomic<size_t> allocCount(0);
+
+void* operator new(size_t size) {
+    allocCount.fetch_add(1, std::memory_order_relaxed);
+    void* p = std::malloc(size ? size : 1);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+
+static size_t residentBytes() {
+    long pages = 0, resident = 0;
+    FILE* f = std::fopen("/proc/self/statm", "r");
+    if (f) {
+        if (std::fscanf(f, "%ld %ld", &pages, &resident) != 2) resident = 0;
+        std::fclose(f);
+    }
+    return static_cast<size_t>(resident) * sysconf(_SC_PAGE_SIZE);
+}
+
+static void run(bool slab, size_t objects, size_t valueSize) {
+    LRUCache cache(objects * LRUCache::charge(valueSize) * 2);
+    std::vector<char> value(valueSize, 'v');
+
+    size_t rssBefore = residentBytes();
+    size_t allocsBefore = allocCount.load();
+    auto start = std::chrono::steady_clock::now();
+    for (size_t k = 0; k < objects; ++k) {
+        if (slab) {
+            cache.put(static_cast<int>(k), ValueRef::copyOf(value.data(), value.size()));
+        } else {
+            cache.put(static_cast<int>(k), std::vector<char>(value));
+        }
+    }
+    double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    size_t allocs = allocCount.load() - allocsBefore;
+    size_t rss = residentBytes() - rssBefore;
+
+    SlabArena::Stats arena = SlabArena::instance().stats();
+    std::printf("%s %zu %.1f %.2f %.0f %.1f\n", slab ? "slab" : "vector", valueSize,
+                static_cast<double>(rss) / objects, static_cast<double>(allocs) / objects, objects / sec,
+                arena.arenaBytes / 1048576.0);
+}
+
+int main(int argc, char* argv[]) {
+    size_t objects = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+
+    std::printf("payload size bytes/object allocs/put puts/s arena_MB\n");
+    std::fflush(stdout);
+    for (size_t valueSize : {4, 64, 512}) {
+        for (bool slab : {false, true}) {
+            pid_t pid = fork();
+            if (pid == 0) {
+                run(slab, objects, valueSize);
+                std::fflush(stdout);
+                _exit(0);
+            }
+            int status = 0;
+            waitpid(pid, &status, 0);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,57 @@
+#include "ObjectStorage.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fcntl.h>
+#include <unistd.h>
+
+// 启动时间测试：比较有索引和无索引(全量扫描日志)时冷启动打开存储的耗时
+// 用法: StartupBench [对象数量] [对象大小]
+
+static void dropPageCache(const std::string& path) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) return;
+    fdatasync(fd);
+    posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+    close(fd);
+}
+
+static double openStorage(const std::string& path, size_t& recovered) {
+    for (const auto& file : ObjectStorage::storageFiles(path)) dropPageCache(file);
+    auto start = std::chrono::steady_clock::now();
+    ObjectStorage storage(path, 1 << 20);
+    auto end = std::chrono::steady_clock::now();
+    recovered = storage.size();
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+int main(int argc, char* argv[]) {
+    size_t count = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+    size_t valueSize = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 16;
+    const std::string path = "startup_bench.dat";
+
+    ObjectStorage::destroy(path);
+
+    {
+        ObjectStorage storage(path, 1 << 20);
+        std::vector<char> value(valueSize, 'x');
+        for (size_t i = 0; i < count; ++i) {
+            storage.put(static_cast<int>(i), value);
+        }
+    }
+    std::cout << "keys: " << count << ", value size: " << valueSize << std::endl;
+
+    size_t recovered = 0;
+    double withIndex = openStorage(path, recovered);
+    std::cout << "open with index:    " << withIndex << " ms, " << recovered << " keys" << std::endl;
+
+    // 移走索引文件，打开时只能顺序扫描整个数据日志重建
+    std::rename((path + ".idx").c_str(), (path + ".idx.bak").c_str());
+    double withoutIndex = openStorage(path, recovered);
+    std::cout << "open without index: " << withoutIndex << " ms, " << recovered << " keys" << std::endl;
+
+    ObjectStorage::destroy(path);
+    std::remove((path + ".idx.bak").c_str());
+    return 0;
+}
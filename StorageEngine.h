@@ -0,0 +1,30 @@
+#ifndef STORAGE_ENGINE_H
+#define STORAGE_ENGINE_H
+
+#include <vector>
+#include <cstddef>
+
+// 存储引擎的公共接口，ObjectStorage和KVStore都实现它，便于对比测试
+class StorageEngine {
+public:
+    virtual ~StorageEngine() {}
+
+    // 插入或覆盖对象
+    virtual void put(int key, const std::vector<char>& value) = 0;
+
+    // 获取对象，不存在时返回空
+    virtual std::vector<char> get(int key) = 0;
+
+    // 删除对象
+    virtual void del(int key) = 0;
+
+    // 把已接受的写入落到磁盘
+    virtual void flush() = 0;
+
+    // 当前可访问的对象数
+    virtual size_t size() const = 0;
+
+    virtual const char* name() const = 0;
+};
+
+#endif // STORAGE_ENGINE_H
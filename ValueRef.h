@@ -0,0 +1,63 @@
+#ifndef VALUE_REF_H
+#define VALUE_REF_H
+
+#include <vector>
+#include <memory>
+#include <cstring>
+#include <cstddef>
+
+#include "SlabAllocator.h"
+
+// 只读的引用计数缓冲区句柄
+// 缓存命中时只复制句柄(引用计数加一)，不分配内存也不复制数据；
+// 持有句柄期间即使条目被淘汰，底层数据也保持有效
+// 不超过kMaxSlabPayload的缓冲区从slab分配，引用计数和数据在同一个槽里
+class ValueRef {
+public:
+    ValueRef() : ptr(nullptr), len(0) {}
+
+    ValueRef(std::shared_ptr<const void> owner, const char* data, size_t size)
+        : owner(std::move(owner)), ptr(data), len(size) {}
+
+    // 复制一份数据到新分配的缓冲区
+    static ValueRef copyOf(const char* data, size_t size) {
+        char* buf = nullptr;
+        ValueRef value = allocate(size, &buf);
+        if (size > 0) std::memcpy(buf, data, size);
+        return value;
+    }
+
+    // 接管vector的所有权，不复制数据
+    static ValueRef fromVector(std::vector<char>&& value) {
+        std::shared_ptr<std::vector<char>> buf = std::make_shared<std::vector<char>>(std::move(value));
+        return ValueRef(buf, buf->data(), buf->size());
+    }
+
+    // 分配size字节的缓冲区，通过out返回可写指针，用于从磁盘直接读入
+    static ValueRef allocate(size_t size, char** out) {
+        std::shared_ptr<const void> small = slabShared(size, out);
+        if (small) return ValueRef(std::move(small), *out, size);
+        std::shared_ptr<std::vector<char>> buf = std::make_shared<std::vector<char>>(size);
+        *out = buf->data();
+        return ValueRef(buf, buf->data(), buf->size());
+    }
+
+    const char* data() const { return ptr; }
+    size_t size() const { return len; }
+    bool empty() const { return len == 0; }
+
+    // 是否引用了一个对象(区分"不存在"和"空对象")
+    explicit operator bool() const { return owner != nullptr; }
+
+    const char* begin() const { return ptr; }
+    const char* end() const { return ptr + len; }
+
+    std::vector<char> toVector() const { return std::vector<char>(ptr, ptr + len); }
+
+private:
+    std::shared_ptr<const void> owner;
+    const char* ptr;
+    size_t len;
+};
+
+#endif // VALUE_REF_H
@@ -1,153 +1,11 @@
-#include <iostream>
-#include <vector>
-#include <string>
-#include <unordered_map>
-#include <fstream>
-#include <list>
-#include <mutex>
+#include "ObjectStorage.h"
 
-class ObjectStorage {
-public:
-    // 캯
-    ObjectStorage(const std::string& filename, size_t cacheSize);
-    
-    ~ObjectStorage();
-
-    // 
-    void put(int key, const std::vector<char>& value);
-
-    // ȡ
-    std::vector<char> get(int key);
-
-    // ɾ
-    void del(int key);
-
-    // ãӡ
-    void printCache();
-
-private:
-    struct MetaDataEntry {
-        int key;             // Key
-        uint64_t offset;     // ƫ
-        uint32_t size;       // С
-    };
-
-    // LRU
-    class LRUCache {
-    private:
-        size_t capacity;  // 
-        std::list<std::pair<int, std::vector<char>>> itemList;  // ˫¼˳
-        std::unordered_map<int, decltype(itemList.begin())> itemMap;  // ϣٲ
-        std::mutex cacheMutex;  // ڶ߳ͬ
-
-    public:
-        LRUCache(size_t cap) : capacity(cap) {}
-
-        std::vector<char> get(int key);
-        void put(int key, const std::vector<char>& value);
-        void print();
-    };
-
-    std::fstream dataFile;
-    std::unordered_map<int, MetaDataEntry> metadataMap;
-    LRUCache cache;
-};
-
-// ObjectStorage ʵ
-ObjectStorage::ObjectStorage(const std::string& filename, size_t cacheSize) : cache(cacheSize) {
-    dataFile.open(filename, std::ios::in | std::ios::out | std::ios::binary);
-    if (!dataFile) {
-        dataFile.open(filename, std::ios::out | std::ios::binary);
-        dataFile.close();
-        dataFile.open(filename, std::ios::in | std::ios::out | std::ios::binary);
-    }
-}
-
-ObjectStorage::~ObjectStorage() {
-    if (dataFile.is_open()) {
-        dataFile.close();
-    }
-}
-
-void ObjectStorage::put(int key, const std::vector<char>& value) {
-    cache.put(key, value);
-
-    dataFile.seekp(0, std::ios::end);
-    uint64_t offset = dataFile.tellp();
-    uint32_t size = value.size();
-    dataFile.write(value.data(), size);
-
-    MetaDataEntry entry = {key, offset, size};
-    metadataMap[key] = entry;
-}
-
-std::vector<char> ObjectStorage::get(int key) {
-    std::vector<char> data = cache.get(key);
-    if (!data.empty()) return data;
-
-    if (metadataMap.find(key) == metadataMap.end()) return {};
-    MetaDataEntry entry = metadataMap[key];
-
-    data.resize(entry.size);
-    dataFile.seekg(entry.offset);
-    dataFile.read(data.data(), entry.size);
-
-    cache.put(key, data);
-    return data;
-}
-
-void ObjectStorage::del(int key) {
-    cache.put(key, {});
-    metadataMap.erase(key);
-}
-
-void ObjectStorage::printCache() {
-    cache.print();
-}
-
-// LRUCache ʵ
-std::vector<char> ObjectStorage::LRUCache::get(int key) {
-    std::lock_guard<std::mutex> lock(cacheMutex);
-    if (itemMap.find(key) == itemMap.end()) {
-        return {};  // вڸؿֵ
-    }
-
-    itemList.splice(itemList.begin(), itemList, itemMap[key]);
-    return itemMap[key]->second;
-}
-
-void ObjectStorage::LRUCache::put(int key, const std::vector<char>& value) {
-    std::lock_guard<std::mutex> lock(cacheMutex);
-
-    if (itemMap.find(key) != itemMap.end()) {
-        itemList.splice(itemList.begin(), itemList, itemMap[key]);
-        itemMap[key]->second = value;
-        return;
-    }
-
-    if (itemList.size() >= capacity) {
-        auto last = itemList.back();
-        itemMap.erase(last.first);
-        itemList.pop_back();
-    }
-
-    itemList.emplace_front(key, value);
-    itemMap[key] = itemList.begin();
-}
-
-void ObjectStorage::LRUCache::print() {
-    std::lock_guard<std::mutex> lock(cacheMutex);
-    for (const auto& pair : itemList) {
-        std::cout << pair.first << ":" << pair.second.size() << " ";
-    }
-    std::cout << std::endl;
-}
-
-// Դ
+// 测试代码
 int main() {
-    ObjectStorage storage("datafile.dat", 3);  // ûΪ3
+    // 设置缓存容量为3个5字节对象的大小
+    ObjectStorage storage("datafile.dat", 3 * LRUCache::charge(5));
 
-    // 
+    // 插入数据
     std::vector<char> data1 = {'H', 'e', 'l', 'l', 'o'};
     storage.put(1, data1);
 
@@ -157,11 +15,11 @@ int main() {
     std::vector<char> data3 = {'F', 'o', 'o'};
     storage.put(3, data3);
 
-    // ӡǰ
+    // 打印当前缓存
     std::cout << "Initial cache state: ";
     storage.printCache();
 
-    // ȡе
+    // 获取缓存中的数据
     std::cout << "Get key 2: ";
     auto result = storage.get(2);
     for (char c : result) {
@@ -169,13 +27,13 @@ int main() {
     }
     std::cout << std::endl;
 
-    // ݣδʹƳ
+    // 插入新数据，导致最久未使用项被移除
     std::vector<char> data4 = {'B', 'a', 'r'};
     storage.put(4, data4);
     std::cout << "Cache after inserting key 4: ";
     storage.printCache();
 
-    // ԻȡƳ
+    // 尝试获取被移除的项
     std::cout << "Get key 1: ";
     result = storage.get(1);
     if (result.empty()) {
@@ -187,5 +45,10 @@ int main() {
     }
     std::cout << std::endl;
 
+    // 缓存按字节计算的占用
+    LRUCache::Stats stats = storage.cacheStats();
+    std::cout << "Cache resident bytes: " << stats.residentBytes << "/" << stats.capacityBytes
+              << ", entries: " << stats.entries << std::endl;
+
     return 0;
 }